@@ -0,0 +1,226 @@
+// Kernel and end-to-end benchmarks, reported as JSON for tracking across commits.
+//
+// usage: bench [--seed S] [--quick] [--threads N] [--label TEXT] [--out FILE]
+//
+// Every case is timed as the median of several repetitions, each repetition
+// running the kernel until it has taken at least a minimum wall time. Inputs
+// (caves, weights, agent heights) all derive from --seed, so two builds on the
+// same machine measure identical work.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Sim.hpp"
+
+using namespace std;
+
+static volatile float sink; // keeps results observable
+
+// == Timing ==
+struct Timing { double nsPerOp = 0.0, minNsPerOp = 0.0; long long ops = 0; };
+
+// Median ns per op of fn(), which performs opsPerCall operations per call
+template <class F>
+static Timing measure(F&& fn, long long opsPerCall, double minSeconds, int reps) {
+    vector<double> samples;
+    long long total = 0;
+    for (int r = 0; r < reps; ++r) {
+        long long ops = 0;
+        auto t0 = chrono::steady_clock::now();
+        double secs = 0.0;
+        do {
+            fn();
+            ops += opsPerCall;
+            secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        } while (secs < minSeconds);
+        samples.push_back(secs * 1e9 / (double)ops);
+        total += ops;
+    }
+    sort(samples.begin(), samples.end());
+    return Timing{samples[samples.size() / 2], samples.front(), total};
+}
+
+// == JSON output ==
+static string jsonEscape(const string& s) {
+    string r;
+    for (char c : s) {
+        if (c == '"' || c == '\\') r += '\\';
+        if ((unsigned char)c >= 0x20) r += c;
+    }
+    return r;
+}
+
+struct Report {
+    string body; // results array contents
+    // extra: additional ", \"key\": value" members for this result
+    void add(const char* name, int agents, const Timing& t, const char* unit, const string& extra = "") {
+        char buf[512];
+        int n = snprintf(buf, sizeof(buf),
+            "%s\n    {\"name\": \"%s\", \"agents\": %d, \"ns_per_op\": %.3f, \"min_ns_per_op\": %.3f, \"ops\": %lld, \"unit\": \"%s\"",
+            body.empty() ? "" : ",", name, agents, t.nsPerOp, t.minNsPerOp, t.ops, unit);
+        body.append(buf, n);
+        body += extra + "}";
+        fprintf(stderr, "%-28s %6d agents  %12.1f ns/%s\n", name, agents, t.nsPerOp, unit);
+    }
+};
+
+int main(int argc, char** argv) {
+    unsigned seed = 1; // inputs seed
+    bool quick = false; // shorter runs (smoke test)
+    int threads = 0; // pool size for the pooled cases (0 = all cores)
+    string label, outPath; // free-form run label, JSON destination (empty -> stdout)
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--seed") == 0 && hasValue) seed = (unsigned)strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--quick") == 0) quick = true;
+        else if (strcmp(argv[i], "--threads") == 0 && hasValue) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--label") == 0 && hasValue) label = argv[++i];
+        else if (strcmp(argv[i], "--out") == 0 && hasValue) outPath = argv[++i];
+        else { fprintf(stderr, "usage: %s [--seed S] [--quick] [--threads N] [--label TEXT] [--out FILE]\n", argv[0]); return 2; }
+    }
+    const double minSeconds = quick ? 0.02 : 0.2; // per repetition
+    const int reps = quick ? 3 : 5;
+    const vector<int> populations = quick ? vector<int>{50, 500} : vector<int>{50, 500, 5000};
+
+    const int W = 800, H = 600; // world size
+    const float x = 240.f, dt = 1.f / 60.f; // agent X and timestep
+    ThreadPool pool(threads);
+    Report rep;
+
+    // -- castRay: one ray marched against the exact cave --
+    {
+        Cave cave(seed);
+        std::mt19937 rng(seed);
+        float t, b; cave.sample(W, H, x, t, b);
+        std::uniform_real_distribution<float> yDist(t, b);
+        vector<float> ys(1024);
+        for (float& y : ys) y = yDist(rng);
+        size_t k = 0;
+        rep.add("castRay", 1, measure([&] {
+            float acc = 0.f;
+            for (int i = 0; i < 64; ++i, ++k) acc += castRay(cave, W, H, x, ys[k & 1023], rayAngle((int)(k % NUM_RAYS)));
+            sink = acc;
+        }, 64, minSeconds, reps), "ray");
+    }
+
+    // -- Cave::sample: exact profile and through the column cache --
+    for (int cached = 0; cached < 2; ++cached) {
+        Cave cave(seed);
+        if (cached) { cave.enableCache(0.f, (float)W + 1.f); cave.update(VX, dt); }
+        rep.add(cached ? "Cave::sample/cached" : "Cave::sample", 1, measure([&] {
+            float acc = 0.f, t, b;
+            for (int xp = 0; xp < W; ++xp) { cave.sample(W, H, (float)xp, t, b); acc += t + b; }
+            sink = acc;
+        }, W, minSeconds, reps), "sample");
+    }
+
+    // -- Net::forward: one agent, one decision --
+    {
+        Net net(vector<int>{NUM_INPUTS, 16, 8, 1}, seed);
+        vector<float> in(NUM_INPUTS, 0.3f), scratch(net.scratchSize());
+        rep.add("Net::forward", 1, measure([&] {
+            float acc = 0.f;
+            for (int i = 0; i < 64; ++i) { in[0] = (float)i * 0.01f; acc += net.forward(in.data(), scratch.data()); }
+            sink = acc;
+        }, 64, minSeconds, reps), "net");
+    }
+
+    // -- FixedNet::forward: same network, compile-time topology --
+    {
+        AgentFixedNet net(Net(vector<int>{NUM_INPUTS, 16, 8, 1}, seed));
+        vector<float> in(NUM_INPUTS, 0.3f);
+        rep.add("FixedNet::forward", 1, measure([&] {
+            float acc = 0.f;
+            for (int i = 0; i < 64; ++i) { in[0] = (float)i * 0.01f; acc += net.forward(in.data()); }
+            sink = acc;
+        }, 64, minSeconds, reps), "net");
+    }
+
+    // -- Net::mutate: one child per op (geometric skipping + Gaussian noise) --
+    {
+        Net net(vector<int>{NUM_INPUTS, 16, 8, 1}, seed);
+        uint64_t key = seed;
+        rep.add("Net::mutate", 1, measure([&] {
+            for (int i = 0; i < 64; ++i) net.mutate(mutationKey(seed, key++, 0), MUT_SIGMA, MUT_PROB);
+            sink = net.params[0];
+        }, 64, minSeconds, reps), "net");
+    }
+
+    for (int n : populations) {
+        std::mt19937 rng(seed);
+        vector<Agent> agents; agents.reserve(n);
+        for (int i = 0; i < n; ++i) agents.emplace_back(NUM_INPUTS, (unsigned)rng());
+
+        // -- PopulationNet::forward: whole population, one step, per precision --
+        for (InferenceMode mode : {InferenceMode::Exact, InferenceMode::FastTanh, InferenceMode::Int8}) {
+            static const char* names[] = {"PopulationNet::forward", "PopulationNet::forward/fast", "PopulationNet::forward/int8"};
+            PopulationNet batch;
+            batch.setMode(mode);
+            vector<const Net*> nets;
+            for (const Agent& a : agents) nets.push_back(&a.brain);
+            batch.load(nets);
+            for (int a = 0; a < n; ++a)
+                for (int k = 0; k < NUM_INPUTS; ++k) batch.input(a, k) = (float)((a * 7 + k) % 13) / 13.f;
+            vector<uint8_t> alive(n, 1);
+            rep.add(names[(int)mode], n, measure([&] {
+                batch.forward(alive.data());
+                sink = batch.outputs[0];
+            }, n, minSeconds, reps), "agent");
+        }
+
+        // -- evolve: one generation (serial and pooled) --
+        for (int pooled = 0; pooled < 2; ++pooled) {
+            std::mt19937 evoRng(seed);
+            EvolveBuffers buf;
+            int generation = 1;
+            float best = 0.f;
+            vector<Agent> pop = agents;
+            rep.add(pooled ? "evolve/pool" : "evolve", n, measure([&] {
+                for (int i = 0; i < (int)pop.size(); ++i) pop[i].fitness = (float)((i * 2654435761u) % 1000);
+                evolve(pop, buf, evoRng, seed, ELITE_COUNT, MUT_SIGMA, MUT_PROB, generation, best, pooled ? &pool : nullptr);
+            }, 1, minSeconds, reps), "generation");
+        }
+    }
+
+    // -- End to end: generations per second on one fixed seeded cave --
+    for (int n : populations) {
+        std::mt19937 rng(seed);
+        vector<Agent> agents; agents.reserve(n);
+        for (int i = 0; i < n; ++i) agents.emplace_back(NUM_INPUTS, (unsigned)rng());
+        EvolveBuffers buf;
+        Simulation sim;
+        sim.pool = &pool;
+        const Cave cave(seed); // same cave every generation
+        const int maxSteps = 3600; // one sim-minute cap keeps generations comparable
+        int generation = 1;
+        float best = 0.f;
+        long long steps = 0;
+        Timing t = measure([&] {
+            sim.resetGeneration(agents, cave);
+            while (sim.step(agents, dt)) {
+                if (sim.steps >= maxSteps) { sim.killAll(agents); break; }
+            }
+            steps += sim.steps;
+            evolve(agents, buf, rng, seed, ELITE_COUNT, MUT_SIGMA, MUT_PROB, generation, best, &pool);
+        }, 1, minSeconds * 5, reps);
+        char extra[128];
+        snprintf(extra, sizeof(extra), ", \"generations_per_sec\": %.3f, \"steps_per_generation\": %.1f",
+                 t.nsPerOp > 0 ? 1e9 / t.nsPerOp : 0.0, (double)steps / (double)t.ops);
+        rep.add("generation", n, t, "generation", extra);
+    }
+
+    // -- Emit --
+    FILE* out = outPath.empty() ? stdout : fopen(outPath.c_str(), "w");
+    if (!out) { fprintf(stderr, "cannot open %s\n", outPath.c_str()); return 1; }
+    fprintf(out, "{\n  \"label\": \"%s\",\n  \"seed\": %u,\n  \"threads\": %d,\n  \"kernel\": \"%s\",\n"
+                 "  \"compiler\": \"%s\",\n  \"quick\": %s,\n  \"results\": [%s\n  ]\n}\n",
+            jsonEscape(label).c_str(), seed, pool.size(), PopulationNet::kernelName(), __VERSION__, quick ? "true" : "false",
+            rep.body.c_str());
+    if (out != stdout) fclose(out);
+    return 0;
+}
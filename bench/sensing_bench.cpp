@@ -0,0 +1,108 @@
+// Ray sensing benchmark: per-agent ray marching (castRay) versus the shared
+// per-frame SensorField, on the same seeded cave and agent heights.
+//
+// usage: sensing_bench [--tolerance PX] [--frames N] [--seed S] [--cache 0|1]
+// Exits with 1 if the field's wall heights leave the requested tolerance, or
+// if a ray distance differs from castRay's at a sample farther than that
+// tolerance from the marched cave's walls. Ray distances themselves are not
+// bounded by the tolerance: a ray grazing a wall within it may stop at the
+// other path's sample or run on for many steps (see "max diff").
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "Sim.hpp"
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    float tolerance = 0.05f; // wall tolerance of the field (px)
+    int frames = 200; // frames per population size
+    unsigned seed = 1; // cave and agent seed
+    bool cache = false; // sample through the cave column cache
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--tolerance") == 0) tolerance = (float)atof(argv[i + 1]);
+        else if (strcmp(argv[i], "--frames") == 0) frames = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--seed") == 0) seed = (unsigned)strtoul(argv[i + 1], nullptr, 10);
+        else if (strcmp(argv[i], "--cache") == 0) cache = atoi(argv[i + 1]) != 0;
+    }
+
+    const int W = 800, H = 600; // world size
+    const float x = 240.f, dt = 1.f / 60.f; // agent X and timestep
+    float angles[NUM_RAYS];
+    for (int r = 0; r < NUM_RAYS; ++r) angles[r] = rayAngle(r);
+
+    printf("tolerance %.3f px, %d frames, seed %u, column cache %s\n", tolerance, frames, seed, cache ? "on" : "off");
+    printf("%8s %12s %12s %9s %10s %10s %10s %12s %10s\n",
+           "agents", "march ms", "field ms", "speedup", "mismatch%", "max diff", "mean diff", "wall err px", "beyond tol");
+
+    bool ok = true;
+    for (int agents : {50, 500, 5000}) {
+        Cave cave(seed); // same cave for both paths
+        if (cache) cave.enableCache(0.f, x + RAY_MAX + 1.f);
+        std::mt19937 rng(seed);
+        SensorField field; field.tolerance = tolerance;
+        vector<float> ys(agents), ref((size_t)agents * NUM_RAYS), got((size_t)agents * NUM_RAYS);
+
+        double marchSec = 0.0, fieldSec = 0.0, sumDiff = 0.0;
+        float maxDiff = 0.f, wallErr = 0.f;
+        long long mismatches = 0, rays = 0;
+        long long beyond = 0; // mismatched rays not decided within the tolerance of a wall
+        for (int f = 0; f < frames; ++f) {
+            cave.update(VX, dt);
+            float t, b; cave.sample(W, H, x, t, b);
+            std::uniform_real_distribution<float> yDist(t, b); // agents inside the corridor
+            for (float& y : ys) y = yDist(rng);
+
+            auto t0 = chrono::steady_clock::now();
+            for (int a = 0; a < agents; ++a)
+                for (int r = 0; r < NUM_RAYS; ++r)
+                    ref[(size_t)a * NUM_RAYS + r] = castRay(cave, W, H, x, ys[a], angles[r]);
+            auto t1 = chrono::steady_clock::now();
+            field.build(cave, W, H, x, angles, NUM_RAYS, RAY_MAX, RAY_STEP);
+            for (int a = 0; a < agents; ++a)
+                for (int r = 0; r < NUM_RAYS; ++r)
+                    got[(size_t)a * NUM_RAYS + r] = field.distance(r, ys[a]);
+            auto t2 = chrono::steady_clock::now();
+            marchSec += chrono::duration<double>(t1 - t0).count();
+            fieldSec += chrono::duration<double>(t2 - t1).count();
+
+            // The paths may only disagree at the first sample where one of them
+            // hits: there the ray must lie within the field's wall error of the
+            // marched cave's walls (the column cache adds its own error)
+            const float allowed = std::max(0.f, tolerance) + cave.cacheError(cave.scroll + cave.startPhase + x + RAY_MAX) + 1e-3f;
+            for (size_t k = 0; k < ref.size(); ++k) {
+                float d = fabsf(ref[k] - got[k]);
+                if (d > 0.f) {
+                    ++mismatches;
+                    const float angle = angles[k % NUM_RAYS];
+                    const float dx = cosf(angle) * RAY_STEP, dy = sinf(angle) * RAY_STEP;
+                    const int hit = (int)lroundf(std::min(ref[k], got[k]) / RAY_STEP);
+                    float rx = x, ry = ys[k / NUM_RAYS];
+                    for (int j = 0; j < hit; ++j) { rx += dx; ry += dy; } // march exactly like castRay
+                    float t, b; cave.sample(W, H, rx, t, b);
+                    if (fabsf(std::min(ry - t, b - ry)) > allowed) ++beyond;
+                }
+                maxDiff = std::max(maxDiff, d); sumDiff += d; ++rays;
+            }
+            if (tolerance > 0.f) { // interpolated walls against the exact cave
+                Cave exact = cave; exact.columns = CaveColumns{}; // analytic walls
+                for (float xs = x; xs < x + RAY_MAX; xs += 0.37f) {
+                    float et, eb, ft, fb;
+                    exact.sample(W, H, xs, et, eb); field.wallsAt(xs, ft, fb);
+                    wallErr = std::max(wallErr, std::max(fabsf(et - ft), fabsf(eb - fb)));
+                }
+            }
+        }
+        bool pass = wallErr <= tolerance + 1e-3f && beyond == 0; // float noise of the exact sampler
+        ok = ok && pass;
+        printf("%8d %12.3f %12.3f %8.1fx %9.3f%% %10.1f %10.4f %11.4f %10lld%s\n",
+               agents, marchSec * 1e3 / frames, fieldSec * 1e3 / frames, marchSec / fieldSec,
+               100.0 * mismatches / rays, maxDiff, sumDiff / rays, wallErr, beyond, pass ? "" : "  FAIL");
+    }
+    return ok ? 0 : 1;
+}
@@ -3,6 +3,9 @@
 #include <algorithm>
 #include <random>
 #include "NeuralNet.hpp"
+#include "FixedNet.hpp"
+#include "ThreadPool.hpp"
+#include "Profiler.hpp"
 #include "Cave.hpp"
 
 using std::vector;
@@ -14,92 +17,162 @@ struct Agent {
     explicit Agent(int inputCount) 
         : brain(vector<int>{inputCount, 16, 8, 1}), // Deeper network
           fitness(0.f) {}
+    Agent(int inputCount, unsigned seed) // Reproducible initial weights
+        : brain(vector<int>{inputCount, 16, 8, 1}, seed),
+          fitness(0.f) {}
     Agent() : brain(vector<int>{9, 16, 8, 1}), fitness(0.f) {}
 };
 
+// Agent's brain topology with compile-time layer sizes (converts to and from Agent::brain)
+using AgentFixedNet = FixedNet<9, 16, 8, 1>;
+
 // Reset the game state for the agent
-inline void reset_run(float &y, float ARROW_SIZE, int H, float& pxAcc, int& score, Cave& cave, float& vy) {
+inline void reset_run(float &y, float ARROW_SIZE, int H, float& pxAcc, int& score, Cave& cave, float& vy, unsigned caveSeed) {
     score = 0; // Reset score
     pxAcc = 0.0f; // Reset distance
     y = H * 0.5f; // Reset player position
     cave.scroll = 0.f; // Reset cave scroll
-    cave = Cave(); // Create new cave
+    cave = Cave(caveSeed); // Create new cave
     vy = 0.f; // Reset vertical velocity
 }
 
-// Evolve the population of agents using fitness-proportionate selection and mutation
-inline void evolve(vector<Agent>& agents, std::mt19937& rng, int eliteCount, 
-        float mutationSigma, float mutationProb, int& generation, 
-        float& bestFitness) {
-
-    // Sort by fitness (best first)
-    sort(agents.begin(), agents.end(), [](const Agent& a, const Agent& b) {
-        return a.fitness > b.fitness;
-    });
-
-    // Update best fitness
-    if (agents[0].fitness > bestFitness) {
-        bestFitness = agents[0].fitness;
-    }
+// Per-generation fitness statistics reported by evolve
+struct GenStats {
+    int generation = 0; // generation the stats belong to
+    float best = 0.f; // best fitness
+    float avg = 0.f; // average fitness
+    float worst = 0.f; // worst fitness
+};
+
+// Reusable buffers for evolve: the second population buffer and selection scratch
+struct EvolveBuffers {
+    vector<Agent> next; // population being built (swapped with the current one)
+    vector<int> order; // agent indices, partially ordered best first
+    vector<float> cumulative; // roulette prefix sums over the top half
+    vector<int> parents; // chosen parent (agent index) per child slot
+    vector<float> fitness; // agents' fitness, gathered for selectParents
+};
+
+// Rank the population (fitness[i] of genome i) and pick the parent of every child slot
+// Elites and the top half come from a partial selection instead of a full
+// sort, and roulette picks are a binary search over prefix sums. Afterwards
+// buf.order[0, eliteCount) holds the elites (best first) and buf.parents[k]
+// the parent of slot k >= eliteCount. Parents are picked serially from rng.
+inline GenStats selectParents(const vector<float>& fitness, EvolveBuffers& buf, std::mt19937& rng,
+        int eliteCount, int generation, float& bestFitness) {
+    const int n = (int)fitness.size();
+    eliteCount = std::min(eliteCount, n);
+    int topHalf = std::max(1, n / 2); // roulette pool (ignore worst performers)
+
+    // Partial selection (best first): top half, then the elites inside it
+    vector<int>& order = buf.order;
+    order.resize(n);
+    for (int i = 0; i < n; ++i) order[i] = i;
+    auto better = [&](int a, int b) {
+        if (fitness[a] != fitness[b]) return fitness[a] > fitness[b];
+        return a < b; // deterministic ties
+    };
+    std::nth_element(order.begin(), order.begin() + topHalf - 1, order.end(), better);
+    std::partial_sort(order.begin(), order.begin() + std::max(1, eliteCount), order.begin() + topHalf, better);
 
     // Calculate statistics
     float avgFitness = 0.0f;
-    for (const auto& a : agents) {
-    avgFitness += a.fitness;
+    float worstFitness = fitness[0];
+    for (float f : fitness) {
+        avgFitness += f;
+        worstFitness = std::min(worstFitness, f);
     }
-    avgFitness /= agents.size();
-
-    SDL_Log("Gen %d: Best=%.1f, Avg=%.1f, Worst=%.1f", 
-    generation, agents[0].fitness, avgFitness, agents.back().fitness);
+    avgFitness /= n;
 
-    vector<Agent> newAgents;
-    newAgents.reserve(agents.size());
-
-    // Elitism: preserve top agents
-    for (int i = 0; i < eliteCount && i < (int)agents.size(); ++i) {
-        Agent elite(agents[i].brain.layers[0].neurons[0].weights.size() - 1);
-        elite.brain.copyWeightsFrom(agents[i].brain);
-        elite.fitness = 0.f;
-        newAgents.push_back(elite);
+    const float best = fitness[order[0]];
+    if (best > bestFitness) { // Update best fitness
+        bestFitness = best;
     }
 
+    GenStats stats;
+    stats.generation = generation;
+    stats.best = best;
+    stats.avg = avgFitness;
+    stats.worst = worstFitness;
+
     // FITNESS-PROPORTIONATE SELECTION (Roulette Wheel)
-    // Calculate fitness sum for top 50% (ignore worst performers)
-    int topHalf = agents.size() / 2;
+    // Prefix sums of fitness over the top 50%
+    vector<float>& cumulative = buf.cumulative;
+    cumulative.resize(topHalf);
     float fitnessSum = 0.0f;
     for (int i = 0; i < topHalf; ++i) {
-        fitnessSum += std::max(0.0f, agents[i].fitness); // Avoid negative fitness
+        fitnessSum += std::max(0.0f, fitness[order[i]]); // Avoid negative fitness
+        cumulative[i] = fitnessSum;
     }
 
     std::uniform_real_distribution<float> dist(0.0f, fitnessSum);
 
-    // Fill rest with mutated offspring
-    while (newAgents.size() < agents.size()) {
-        // Select parent based on fitness
+    // Select parents for the rest of the population
+    vector<int>& parents = buf.parents;
+    parents.resize(n);
+    for (int k = eliteCount; k < n; ++k) {
+        // Select parent based on fitness: first prefix sum reaching the pick
         int parentIdx = 0;
         if (fitnessSum > 0.0f) {
             float pick = dist(rng);
-            float cumulative = 0.0f;
-
-            for (int i = 0; i < topHalf; ++i) {
-            cumulative += std::max(0.0f, agents[i].fitness);
-                if (cumulative >= pick) {
-                   parentIdx = i;
-                    break;
-                }
-            }
+            parentIdx = (int)(std::lower_bound(cumulative.begin(), cumulative.end(), pick) - cumulative.begin());
+            parentIdx = std::min(parentIdx, topHalf - 1);
         } else {
             // Fallback if all fitness is 0
-            parentIdx = rng() % eliteCount;
+            parentIdx = eliteCount > 0 ? (int)(rng() % eliteCount) : 0;
         }
+        parents[k] = order[parentIdx];
+    }
+    return stats;
+}
 
-        Agent child(agents[parentIdx].brain.layers[0].neurons[0].weights.size() - 1);
-        child.brain.copyWeightsFrom(agents[parentIdx].brain);
-        child.brain.mutate(rng, mutationSigma, mutationProb);
-        child.fitness = 0.f;
-        newAgents.push_back(child);
+inline GenStats selectParents(const vector<Agent>& agents, EvolveBuffers& buf, std::mt19937& rng,
+        int eliteCount, int generation, float& bestFitness) {
+    buf.fitness.resize(agents.size());
+    for (size_t i = 0; i < agents.size(); ++i) buf.fitness[i] = agents[i].fitness;
+    return selectParents(buf.fitness, buf, rng, eliteCount, generation, bestFitness);
+}
+
+// Evolve the population of agents using fitness-proportionate selection and mutation
+// Genomes are copied in place into the second buffer (no Agent construction or
+// allocation after the first generation). Copying and mutating the children
+// runs in parallel on the optional pool, each child mutated from its own
+// counter stream mutationKey(seed, generation, child).
+inline GenStats evolve(vector<Agent>& agents, EvolveBuffers& buf, std::mt19937& rng, uint64_t seed,
+        int eliteCount, float mutationSigma, float mutationProb, int& generation, 
+        float& bestFitness, ThreadPool* pool = nullptr) {
+    PROFILE_SCOPE("evolve");
+
+    const int n = (int)agents.size();
+    eliteCount = std::min(eliteCount, n);
+    GenStats stats = selectParents(agents, buf, rng, eliteCount, generation, bestFitness);
+    const vector<int>& order = buf.order;
+    const vector<int>& parents = buf.parents;
+
+    // Second buffer: allocated once, then genomes are overwritten in place
+    vector<Agent>& next = buf.next;
+    if ((int)next.size() != n) next = agents;
+
+    // Elitism: preserve top agents
+    for (int i = 0; i < eliteCount; ++i) {
+        next[i].brain.copyWeightsFrom(agents[order[i]].brain);
+        next[i].fitness = 0.f;
     }
 
-    agents = std::move(newAgents);
+    // Fill rest with mutated offspring (independent per child)
+    PROFILE_SCOPE("evolve/children");
+    auto makeChildren = [&](int begin, int end, int) {
+        for (int k = begin; k < end; ++k) {
+            Agent& child = next[k];
+            child.brain.copyWeightsFrom(agents[parents[k]].brain);
+            child.brain.mutate(mutationKey(seed, (uint64_t)generation, (uint64_t)k), mutationSigma, mutationProb);
+            child.fitness = 0.f;
+        }
+    };
+    if (pool) pool->parallelFor(n - eliteCount, 64, [&](int b, int e, int w) { makeChildren(b + eliteCount, e + eliteCount, w); });
+    else makeChildren(eliteCount, n, 0);
+
+    agents.swap(next); // O(1): the old generation becomes next time's buffer
     generation++;
-}
\ No newline at end of file
+    return stats;
+}
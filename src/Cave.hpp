@@ -1,8 +1,18 @@
 #pragma once
-#include <SDL2/SDL.h>
 #include <cmath>
 #include <algorithm>
 #include <random>
+#include <vector>
+
+// Ring buffer of cave columns at integer world X (see Cave::enableCache)
+struct CaveColumns {
+    std::vector<float> offset; // center offset from H/2 per column
+    std::vector<float> gap; // gap size per column (after the safety floor)
+    long long first = 0; // first cached world column
+    long long count = 0; // number of cached columns
+    size_t mask = 0; // capacity - 1 (capacity is a power of two), 0 = disabled
+    float xLo = 0.f, xHi = 0.f; // screen X span kept cached
+};
 
 // Cave structure to represent cave parameters and update logic
 struct Cave {
@@ -25,12 +35,17 @@ struct Cave {
 
     // 
     float startPhase = 0.f; // Starting phase for cave generation
+    unsigned seed = 0; // Seed the layout was drawn from (see caveSeed)
+
+    CaveColumns columns; // Cached columns (filled incrementally by update)
 
     // Constructor to initialize cave parameters
-    Cave() {
+    // The layout is a pure function of the seed: derive it from the run seed
+    // and the generation (caveSeed) to fly the same cave again.
+    Cave() : Cave(0u) {} // Fixed default layout
+    explicit Cave(unsigned int seed) : seed(seed) {
         // Randomly initialize path frequency
-        Uint64 seed = SDL_GetPerformanceCounter(); // Use performance counter as seed
-        std::mt19937 rng(static_cast<unsigned int>(seed));
+        std::mt19937 rng(seed);
 
         // Random distributions for cave parameters
         std::uniform_real_distribution<float> dist(-0.0005f, 0.0005f);
@@ -40,46 +55,198 @@ struct Cave {
         std::uniform_real_distribution<float> distPhase(10000.f, 30000.f);
         startPhase = distPhase(rng);
     }
-    Cave(float g, float a, float f) {
+    // Given shape, start phase drawn from the seed (same range as Cave(seed))
+    Cave(float g, float a, float f, unsigned int seed = 0) : seed(seed) {
         baseGap = g;
         pathAmp = a;
         pathFreq = f;
-        // Randomly initialize path frequency
-        Uint64 seed = SDL_GetPerformanceCounter(); // Use performance counter as seed
-        std::mt19937 rng(static_cast<unsigned int>(seed));
-        
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> distPhase(10000.f, 30000.f);
+        startPhase = distPhase(rng);
     }
 
     // Update cave scroll based on horizontal velocity and delta time
     void update(float vx, float deltaTime) {
         scroll += vx * deltaTime; // Update scroll based on horizontal velocity
+        if (columns.mask) fillColumns(); // Only the newly exposed columns
     }
 
-    // Sample the cave at a given x position to get top and bottom Y coordinates
-    void sample(int W, int H, float x, float& topY, float& botY) const {
-        const float xWorld = scroll + x + startPhase; // World X position
-    
+    // Cache the columns covering screen X in [xLo, xHi]; lookups outside fall back to exact sampling
+    void enableCache(float xLo, float xHi) {
+        size_t need = (size_t)std::ceil(xHi - xLo) + 4; // span plus interpolation neighbours
+        size_t cap = 64;
+        while (cap < need) cap <<= 1;
+        if (cap - 1 != columns.mask) { // (re)allocate and refill
+            columns.offset.assign(cap, 0.f);
+            columns.gap.assign(cap, 0.f);
+            columns.mask = cap - 1;
+            columns.count = 0;
+        }
+        columns.xLo = xLo; columns.xHi = xHi;
+        fillColumns();
+    }
+
+    // Slide the cached window to the current scroll, computing only new columns
+    void fillColumns() {
+        CaveColumns& C = columns;
+        const float base = scroll + startPhase; // world X of screen X = 0
+        long long lo = (long long)std::floor(base + C.xLo) - 1; // first needed column
+        long long hi = (long long)std::floor(base + C.xHi) + 2; // last needed column
+        if (hi - lo + 1 > (long long)(C.mask + 1)) hi = lo + (long long)C.mask; // span clipped to capacity
+        if (C.count == 0 || lo < C.first || lo >= C.first + C.count) { // jumped: start over
+            C.first = lo; C.count = 0;
+        } else { // evict columns that scrolled off
+            C.count -= lo - C.first; C.first = lo;
+        }
+        for (long long c = C.first + C.count; c <= hi; ++c) { // newly exposed columns
+            float off, g;
+            shape((float)c, off, g);
+            C.offset[(size_t)c & C.mask] = off;
+            C.gap[(size_t)c & C.mask] = g;
+        }
+        C.count = hi - C.first + 1;
+    }
+
+    // Center offset (from H/2) and gap size at a world X position
+    void shape(float xWorld, float& offset, float& gap) const {
         float localFreq = pathFreq + 0.0005f * sin(0.0003f * xWorld);
         // Compute sine waves for cave path
         float s1 = sin(localFreq * xWorld);
         float s2 = sin(pathFreq2 * xWorld + pathPhase);
 
-        // Compute center Y position of the cave
-        const float center = H * 0.5f + (s1 * pathAmp + s2 * pathAmp2);
+        // Offset of the cave center from the middle of the screen
+        offset = s1 * pathAmp + s2 * pathAmp2;
     
         // Compute the gap size with jitter
-        float gap = baseGap + gapJitter * std::sin(gapFreq * xWorld + 2.0f);
+        gap = baseGap + gapJitter * std::sin(gapFreq * xWorld + 2.0f);
         if (gap < 80.f) {
             gap = 80.f; // safety floor
         }
-    
+    }
+
+    // Unclamped wall heights at a world X position (the smooth part of sample)
+    void profile(float xWorld, float H, float& top, float& bot) const {
+        float offset, gap;
+        shape(xWorld, offset, gap);
+
+        // Compute center Y position of the cave
+        const float center = H * 0.5f + offset;
+
         // Compute top and bottom Y positions
-        float top = center - gap * 0.5f;
-        float bot = center + gap * 0.5f;
-    
-        // Apply margins to top and bottom 
+        top = center - gap * 0.5f;
+        bot = center + gap * 0.5f;
+    }
+
+    // Unclamped wall heights, interpolated from the column cache when it covers xWorld
+    void walls(float xWorld, float H, float& top, float& bot) const {
+        const CaveColumns& C = columns;
+        float fl = std::floor(xWorld);
+        long long c = (long long)fl;
+        if (C.mask == 0 || c < C.first || c + 1 >= C.first + C.count) { // not cached
+            profile(xWorld, H, top, bot);
+            return;
+        }
+        float f = xWorld - fl; // fractional part
+        size_t i0 = (size_t)c & C.mask, i1 = (size_t)(c + 1) & C.mask;
+        const float center = H * 0.5f + (C.offset[i0] + (C.offset[i1] - C.offset[i0]) * f);
+        const float gap = C.gap[i0] + (C.gap[i1] - C.gap[i0]) * f;
+        top = center - gap * 0.5f;
+        bot = center + gap * 0.5f;
+    }
+
+    // Apply the top and bottom margins to unclamped wall heights
+    void clampWalls(int H, float& top, float& bot) const {
         top = std::max(margin, top);
         bot = std::min((float)H - margin, bot);
+    }
+
+    // Max wall error added by the column cache (linear interpolation over 1 px,
+    // plus the slope jump of at most gapJitter*gapFreq/2 at the gap floor)
+    float cacheError(float xWorldMax) const {
+        if (!columns.mask) return 0.f;
+        return curvatureBound(xWorldMax) / 8.f + 0.5f * gapJitter * gapFreq / 4.f;
+    }
+
+    // Upper bound on |d²wall/dx²| for world X up to xWorldMax (before margin clamping)
+    float curvatureBound(float xWorldMax) const {
+        const float fm = 0.0005f, fs = 0.0003f; // frequency modulation of the primary wave
+        float phase1 = std::fabs(pathFreq) + fm + fm * fs * xWorldMax; // |d phase / dx|
+        float phase2 = 2.f * fm * fs + fm * fs * fs * xWorldMax; // |d² phase / dx²|
+        float c = pathAmp * (phase1 * phase1 + phase2); // primary wave
+        c += pathAmp2 * pathFreq2 * pathFreq2; // secondary wave
+        c += 0.5f * gapJitter * gapFreq * gapFreq; // half of the gap variation
+        return c;
+    }
+
+    // == Swept wall test ==
+    // Earliest t in [0, 1] at which a point at screen X x, moving linearly from
+    // y0 to y1 while the scroll goes from scroll0 to scroll1, leaves the
+    // corridor. Exact walls (no column cache). Each wall constraint is a
+    // smooth function of t whose second derivative is at least -M, with M the
+    // curvature bound times the scrolled distance squared (the gap floor only
+    // adds convex kinks), so on [a, b] it stays above min(ends) - M (b-a)^2 / 8:
+    // intervals that pass are skipped, the rest are bisected left first.
+    // The margins are straight lines, so their ends decide. Returns false if
+    // the path stays inside (to within a 1e-4 step).
+    bool sweep(int H, float x, float scroll0, float scroll1, float y0, float y1, float& tHit) const {
+        const float span = scroll1 - scroll0; // world distance scrolled
+        const float xw0 = scroll0 + x + startPhase;
+        const float M = curvatureBound(std::max(std::fabs(xw0), std::fabs(xw0 + span))) * span * span;
+        float best = 2.f; // earliest contact so far (> 1 = none)
+
+        // Straight margins: the crossing of a line
+        auto line = [&](float c0, float c1) { // clearance c0 at t = 0, c1 at t = 1
+            if (c1 < 0.f && c0 >= 0.f) best = std::min(best, c0 / (c0 - c1));
+            else if (c0 < 0.f) best = std::min(best, 0.f);
+        };
+        line(y0 - margin, y1 - margin);
+        line((float)H - margin - y0, (float)H - margin - y1);
+
+        // Smooth walls: side 0 = clearance below the top wall, side 1 = above the bottom wall
+        for (int side = 0; side < 2; ++side) {
+            auto clearance = [&](float t) {
+                float top, bot;
+                profile(xw0 + t * span, (float)H, top, bot);
+                const float y = y0 + t * (y1 - y0);
+                return side == 0 ? y - top : bot - y;
+            };
+            struct Span { float a, ga, b, gb; };
+            Span stack[32];
+            int n = 0;
+            const float g0 = clearance(0.f);
+            if (g0 < 0.f) { best = std::min(best, 0.f); continue; }
+            stack[n++] = {0.f, g0, 1.f, clearance(1.f)};
+            while (n > 0) {
+                const Span s = stack[--n];
+                if (s.a >= best) continue; // a contact was already found earlier
+                const float w = s.b - s.a;
+                if (s.gb >= 0.f && std::min(s.ga, s.gb) - M * w * w * 0.125f >= 0.f) continue; // provably clear
+                if (w < 1e-4f || n + 2 > 32) { // resolved to the tolerance
+                    if (s.gb < 0.f) best = std::min(best, s.b);
+                    continue;
+                }
+                const float m = 0.5f * (s.a + s.b), gm = clearance(m);
+                if (gm < 0.f) { // contact at or before m: the right half cannot be earlier
+                    stack[n++] = {s.a, s.ga, m, gm};
+                } else {
+                    stack[n++] = {m, gm, s.b, s.gb}; // right, searched after
+                    stack[n++] = {s.a, s.ga, m, gm}; // left first
+                }
+            }
+        }
+        if (best > 1.f) return false;
+        tHit = best;
+        return true;
+    }
+
+    // Sample the cave at a given x position to get top and bottom Y coordinates
+    void sample(int W, int H, float x, float& topY, float& botY) const {
+        const float xWorld = scroll + x + startPhase; // World X position
+        float top, bot;
+        walls(xWorld, (float)H, top, bot);
+
+        // Apply margins to top and bottom 
+        clampWalls(H, top, bot);
     
         // Output the sampled top and bottom Y positions
         topY = top; 
@@ -0,0 +1,333 @@
+#include "Checkpoint.hpp"
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define NRR_HAVE_MMAP 1
+#endif
+
+using namespace std;
+
+static const char MAGIC[8] = {'N', 'R', 'R', 'C', 'K', 'P', 'T', '\0'};
+
+// == Little-endian encoding ==
+static bool hostLittleEndian() {
+    const uint16_t probe = 1;
+    unsigned char b; memcpy(&b, &probe, 1);
+    return b == 1;
+}
+
+static void put32(unsigned char* p, uint32_t v) { for (int i = 0; i < 4; ++i) p[i] = (unsigned char)(v >> (8 * i)); }
+static void put64(unsigned char* p, uint64_t v) { for (int i = 0; i < 8; ++i) p[i] = (unsigned char)(v >> (8 * i)); }
+static uint32_t get32(const unsigned char* p) { uint32_t v = 0; for (int i = 0; i < 4; ++i) v |= (uint32_t)p[i] << (8 * i); return v; }
+static uint64_t get64(const unsigned char* p) { uint64_t v = 0; for (int i = 0; i < 8; ++i) v |= (uint64_t)p[i] << (8 * i); return v; }
+static uint32_t floatBits(float f) { uint32_t u; memcpy(&u, &f, 4); return u; }
+static float bitsFloat(uint32_t u) { float f; memcpy(&f, &u, 4); return f; }
+
+// FNV-1a over a byte range, continuing from h (catches truncated or corrupted files)
+static uint64_t fnv1a(const unsigned char* p, size_t n, uint64_t h = 0xCBF29CE484222325ull) {
+    for (size_t i = 0; i < n; ++i) { h ^= p[i]; h *= 0x100000001B3ull; }
+    return h;
+}
+
+// Checksum of a checkpoint: header up to the hash field, rng state, weights, chains
+static uint64_t checkpointHash(const unsigned char* header, const unsigned char* rng, size_t rngSize,
+                               const unsigned char* weights, size_t weightBytes,
+                               const unsigned char* chains, size_t chainBytes) {
+    return fnv1a(chains, chainBytes, fnv1a(weights, weightBytes, fnv1a(rng, rngSize, fnv1a(header, 112))));
+}
+
+static size_t alignUp(size_t v, size_t a) { return (v + a - 1) / a * a; }
+
+// == Capture ==
+static void captureTraining(int population, int generation, int highScore, float bestFitnessEver,
+                            uint64_t runSeed, const std::mt19937& rng, CheckpointState& out) {
+    out.population = population;
+    out.generation = generation;
+    out.highScore = highScore;
+    out.bestFitnessEver = bestFitnessEver;
+    out.runSeed = runSeed;
+    ostringstream rs; rs << rng; // textual state is portable across standard libraries
+    out.rngState = rs.str();
+}
+
+void captureCheckpoint(const vector<Agent>& agents, int generation, int highScore, float bestFitnessEver,
+                       uint64_t runSeed, const std::mt19937& rng, CheckpointState& out) {
+    captureTraining((int)agents.size(), generation, highScore, bestFitnessEver, runSeed, rng, out);
+    out.chains.clear();
+    out.topology.clear();
+    out.floatsPerAgent = 0;
+    if (agents.empty()) { out.weights.clear(); return; }
+    const Net& first = agents[0].brain;
+    out.topology.push_back(first.inputSize());
+    for (const Layer& L : first.layers) {
+        out.topology.push_back(L.outSize);
+        out.floatsPerAgent += (int)L.blockSize();
+    }
+
+    out.weights.resize((size_t)out.population * out.floatsPerAgent);
+    float* dst = out.weights.data();
+    for (const Agent& a : agents) { // strip the alignment padding
+        for (const Layer& L : a.brain.layers) {
+            memcpy(dst, a.brain.params.data() + L.offset, L.blockSize() * sizeof(float));
+            dst += L.blockSize();
+        }
+    }
+}
+
+void captureCheckpoint(const vector<SeedGenome>& genomes, const vector<int>& topology, int generation,
+                       int highScore, float bestFitnessEver, uint64_t runSeed, const std::mt19937& rng,
+                       CheckpointState& out) {
+    captureTraining((int)genomes.size(), generation, highScore, bestFitnessEver, runSeed, rng, out);
+    out.topology = topology;
+    out.floatsPerAgent = 0;
+    for (size_t l = 0; l + 1 < topology.size(); ++l) out.floatsPerAgent += (topology[l] + 1) * topology[l + 1];
+    out.weights.clear();
+    out.chains.clear();
+    for (const SeedGenome& g : genomes) g.write(out.chains);
+}
+
+// == Write ==
+bool writeCheckpoint(const std::string& path, const CheckpointState& s, std::string& error) {
+    if ((int)s.topology.size() < 2 || (int)s.topology.size() > CHECKPOINT_MAX_LAYERS) {
+        error = "unsupported topology";
+        return false;
+    }
+    const size_t rngOffset = CHECKPOINT_HEADER_SIZE;
+    const size_t weightsOffset = alignUp(rngOffset + s.rngState.size(), 64);
+    const size_t weightBytes = s.weights.size() * sizeof(float);
+    const size_t chainsOffset = s.chains.empty() ? 0 : weightsOffset + weightBytes;
+
+    // Blob in little-endian order
+    vector<unsigned char> blob(weightBytes);
+    if (hostLittleEndian()) {
+        if (weightBytes) memcpy(blob.data(), s.weights.data(), weightBytes);
+    } else {
+        for (size_t i = 0; i < s.weights.size(); ++i) put32(&blob[4 * i], floatBits(s.weights[i]));
+    }
+
+    unsigned char h[CHECKPOINT_HEADER_SIZE] = {};
+    memcpy(h, MAGIC, 8);
+    put32(h + 8, CHECKPOINT_VERSION);
+    put32(h + 12, (uint32_t)s.topology.size());
+    for (size_t l = 0; l < s.topology.size(); ++l) put32(h + 16 + 4 * l, (uint32_t)s.topology[l]);
+    put32(h + 48, (uint32_t)s.population);
+    put32(h + 52, (uint32_t)s.generation);
+    put32(h + 56, (uint32_t)s.highScore);
+    put32(h + 60, floatBits(s.bestFitnessEver));
+    put64(h + 64, s.runSeed);
+    put32(h + 72, (uint32_t)s.floatsPerAgent);
+    put32(h + 76, (uint32_t)s.rngState.size());
+    put64(h + 80, rngOffset);
+    put64(h + 88, weightsOffset);
+    put64(h + 96, chainsOffset);
+    put64(h + 104, s.chains.size());
+    put64(h + 112, checkpointHash(h, (const unsigned char*)s.rngState.data(), s.rngState.size(), blob.data(), blob.size(),
+                                  s.chains.data(), s.chains.size()));
+
+    const std::string tmp = path + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) { error = "cannot open " + tmp; return false; }
+    static const unsigned char zeros[64] = {};
+    const size_t pad = weightsOffset - rngOffset - s.rngState.size();
+    bool ok = fwrite(h, 1, sizeof(h), f) == sizeof(h)
+           && fwrite(s.rngState.data(), 1, s.rngState.size(), f) == s.rngState.size()
+           && fwrite(zeros, 1, pad, f) == pad
+           && fwrite(blob.data(), 1, blob.size(), f) == blob.size()
+           && fwrite(s.chains.data(), 1, s.chains.size(), f) == s.chains.size()
+           && fflush(f) == 0;
+#ifdef NRR_HAVE_MMAP
+    ok = ok && fsync(fileno(f)) == 0; // durable before it replaces the old checkpoint
+#endif
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+        remove(tmp.c_str());
+        error = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+// == Read ==
+void MappedCheckpoint::close() {
+#ifdef NRR_HAVE_MMAP
+    if (mapped && data) munmap((void*)data, size);
+#endif
+    data = nullptr; size = 0; mapped = false;
+    owned.clear(); swapped.clear(); weights = nullptr; chains = nullptr; chainBytes = 0;
+}
+
+bool MappedCheckpoint::open(const std::string& path, std::string& error) {
+    close();
+#ifdef NRR_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) { error = "cannot open " + path; return false; }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) { data = (const unsigned char*)p; size = (size_t)st.st_size; mapped = true; }
+    }
+    ::close(fd);
+#endif
+    if (!data) { // no mmap: read the whole file
+        FILE* f = fopen(path.c_str(), "rb");
+        if (!f) { error = "cannot open " + path; return false; }
+        unsigned char buf[1 << 16];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) owned.insert(owned.end(), buf, buf + n);
+        fclose(f);
+        data = owned.data(); size = owned.size();
+    }
+
+    // Header
+    if (size < CHECKPOINT_HEADER_SIZE || memcmp(data, MAGIC, 8) != 0) { error = path + " is not a checkpoint"; return false; }
+    const uint32_t version = get32(data + 8);
+    if (version != CHECKPOINT_VERSION) { error = "unsupported checkpoint version " + to_string(version); return false; }
+    const uint32_t layerCount = get32(data + 12);
+    if (layerCount < 2 || layerCount > (uint32_t)CHECKPOINT_MAX_LAYERS) { error = "bad layer count"; return false; }
+    topology.resize(layerCount);
+    for (uint32_t l = 0; l < layerCount; ++l) topology[l] = (int)get32(data + 16 + 4 * l);
+    population = (int)get32(data + 48);
+    generation = (int)get32(data + 52);
+    highScore = (int)get32(data + 56);
+    bestFitnessEver = bitsFloat(get32(data + 60));
+    runSeed = get64(data + 64);
+    floatsPerAgent = (int)get32(data + 72);
+    const uint64_t rngSize = get32(data + 76), rngOffset = get64(data + 80);
+    const uint64_t weightsOffset = get64(data + 88);
+    const uint64_t chainsOffset = get64(data + 96), chainsSize = get64(data + 104), hash = get64(data + 112);
+
+    // Sections must lie inside the file and agree with the topology (no weights next to chains)
+    uint64_t expectFloats = 0;
+    for (uint32_t l = 0; l + 1 < layerCount; ++l) expectFloats += (uint64_t)(topology[l] + 1) * topology[l + 1];
+    const bool hasChains = chainsOffset != 0;
+    const uint64_t weightBytes = hasChains ? 0 : (uint64_t)population * floatsPerAgent * sizeof(float);
+    if (expectFloats != (uint64_t)floatsPerAgent || rngOffset + rngSize > size
+        || weightsOffset % 4 != 0 || weightsOffset + weightBytes > size
+        || (hasChains && (chainsOffset > size || size - chainsOffset < chainsSize))) {
+        error = path + " is truncated or inconsistent";
+        return false;
+    }
+    if (checkpointHash(data, data + rngOffset, (size_t)rngSize, data + weightsOffset, (size_t)weightBytes,
+                       hasChains ? data + chainsOffset : nullptr, (size_t)chainsSize) != hash) {
+        error = path + " failed its checksum";
+        return false;
+    }
+    rngState.assign((const char*)data + rngOffset, (size_t)rngSize);
+    if (hasChains) { // genomes only: no weights to map
+        chains = data + chainsOffset;
+        chainBytes = (size_t)chainsSize;
+        return true;
+    }
+
+    if (hostLittleEndian()) {
+        weights = (const float*)(data + weightsOffset); // zero-copy (offset is 64-byte aligned)
+    } else {
+        swapped.resize((size_t)population * floatsPerAgent);
+        for (size_t i = 0; i < swapped.size(); ++i) swapped[i] = bitsFloat(get32(data + weightsOffset + 4 * i));
+        weights = swapped.data();
+    }
+    return true;
+}
+
+bool loadCheckpoint(const std::string& path, vector<Agent>& agents, int& generation, int& highScore,
+                    float& bestFitnessEver, uint64_t& runSeed, std::mt19937& rng, std::string& error,
+                    vector<SeedGenome>* genomes) {
+    MappedCheckpoint ck;
+    if (!ck.open(path, error)) return false;
+    if (ck.population <= 0) { error = path + " holds no agents"; return false; }
+    if (genomes && !ck.chains) { error = path + " holds weights, not seed chains"; return false; }
+
+    istringstream rs(ck.rngState);
+    std::mt19937 restored;
+    if (!(rs >> restored)) { error = path + " has a bad rng state"; return false; }
+
+    {
+        const Net probe = Agent(ck.topology[0], 0u).brain; // the agents' topology for this input size
+        bool match = (int)probe.layers.size() + 1 == (int)ck.topology.size();
+        for (size_t l = 0; match && l < probe.layers.size(); ++l) match = probe.layers[l].outSize == ck.topology[l + 1];
+        if (!match) { error = path + " has a different network topology"; return false; }
+    }
+
+    vector<SeedGenome> chains;
+    if (ck.chains) {
+        chains.resize(ck.population);
+        SeedLinkIndex shared; // relatives share their history again, as in the saved run
+        size_t pos = 0;
+        bool ok = true;
+        for (size_t i = 0; i < chains.size() && ok; ++i) ok = SeedGenome::read(ck.chains, ck.chainBytes, pos, chains[i], &shared);
+        if (!ok || pos != ck.chainBytes) {
+            error = path + " has a truncated or inconsistent chain section";
+            return false;
+        }
+    }
+
+    vector<Agent> loaded;
+    if (!genomes) loaded.reserve(ck.population);
+    GenomeCache cache(ck.topology, ck.chains && !genomes ? (size_t)ck.population : 0); // rebuilds chain checkpoints
+    for (int i = 0; i < (genomes ? 0 : ck.population); ++i) {
+        loaded.emplace_back(ck.topology[0], 0u); // weights are overwritten below
+        Net& net = loaded.back().brain;
+        if (ck.chains) { // weights are a pure function of the chain
+            net.copyWeightsFrom(cache.get(chains[i]));
+            continue;
+        }
+        const float* src = ck.agentWeights(i);
+        for (const Layer& L : net.layers) { // restore into the padded blocks
+            memcpy(net.params.data() + L.offset, src, L.blockSize() * sizeof(float));
+            src += L.blockSize();
+        }
+    }
+
+    agents.swap(loaded);
+    if (genomes) genomes->swap(chains);
+    generation = ck.generation;
+    highScore = ck.highScore;
+    bestFitnessEver = ck.bestFitnessEver;
+    runSeed = ck.runSeed;
+    rng = restored;
+    return true;
+}
+
+// == Background writer ==
+CheckpointWriter::~CheckpointWriter() {
+    { lock_guard<mutex> lock(m); stop = true; }
+    cv.notify_all();
+    if (thread.joinable()) thread.join(); // writes anything still pending first
+}
+
+void CheckpointWriter::submit(CheckpointState& state) {
+    { lock_guard<mutex> lock(m); swap(pending, state); hasPending = true; }
+    cv.notify_all();
+}
+
+void CheckpointWriter::flush() {
+    unique_lock<mutex> lock(m);
+    cv.wait(lock, [&] { return !hasPending && !busy; });
+}
+
+void CheckpointWriter::run() {
+    CheckpointState writing; // state being written (swapped with pending)
+    unique_lock<mutex> lock(m);
+    for (;;) {
+        cv.wait(lock, [&] { return hasPending || stop; });
+        if (!hasPending) return; // stop with nothing left to write
+        swap(writing, pending);
+        hasPending = false;
+        busy = true;
+        lock.unlock();
+
+        std::string error;
+        bool ok = writeCheckpoint(path, writing, error);
+
+        lock.lock();
+        busy = false;
+        if (ok) ++written; else lastError = error;
+        cv.notify_all();
+    }
+}
@@ -0,0 +1,141 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SeedGenome.hpp"
+
+using std::vector;
+
+// == Population checkpoints ==
+// File layout (version 3, every field little-endian):
+//
+//   offset  size  field
+//        0     8  magic "NRRCKPT\0"
+//        8     4  u32 version
+//       12     4  u32 layer count L (sizes, input included, at most 8)
+//       16    32  u32 layer sizes[8] (e.g. 9,16,8,1, unused = 0)
+//       48     4  u32 population
+//       52     4  i32 generation (next generation to run)
+//       56     4  i32 high score
+//       60     4  f32 best fitness ever
+//       64     8  u64 run seed (keys the mutation streams)
+//       72     4  u32 floats per agent
+//       76     4  u32 rng state size (bytes)
+//       80     8  u64 rng state offset (std::mt19937 textual state)
+//       88     8  u64 weights offset (64-byte aligned)
+//       96     8  u64 chains offset (0 = no chain section)
+//      104     8  u64 chains size (bytes)
+//      112     8  u64 FNV-1a hash of header bytes 0..111, the rng state,
+//                   the weight blob and the chain section (in that order)
+//
+// The weight blob holds population x floats-per-agent f32 values. Each agent
+// is its layers in order, each layer row-major weights [out][in] followed by
+// the out biases (Net's blocks without their alignment padding).
+//
+// A --seed-chains run saves its genomes instead: the chain section holds the
+// population's SeedGenomes back to back in SeedGenome::write's byte form and
+// the weight blob is empty (the weights are a pure function of the chains).
+//
+// Files are written to "<path>.tmp" and renamed into place, so a crash or a
+// preemption mid-write never leaves a torn checkpoint behind.
+
+constexpr uint32_t CHECKPOINT_VERSION = 3;
+constexpr int CHECKPOINT_MAX_LAYERS = 8;
+constexpr size_t CHECKPOINT_HEADER_SIZE = 120;
+
+// Everything needed to resume training exactly where it stopped
+struct CheckpointState {
+    vector<int> topology; // layer sizes, input included
+    int population = 0; // agents
+    int generation = 1; // next generation to run
+    int highScore = 0; // best score so far
+    float bestFitnessEver = 0.f; // best fitness so far
+    uint64_t runSeed = 0; // keys the counter-based mutation streams
+    std::string rngState; // std::mt19937 state (selection and cave seeds)
+    vector<float> weights; // packed weight blob, population x floatsPerAgent (empty with chains)
+    int floatsPerAgent = 0; // packed floats per agent
+    vector<uint8_t> chains; // serialized SeedGenomes (empty unless a --seed-chains run)
+};
+
+// Pack the population and the training state (reuses out's buffers)
+void captureCheckpoint(const vector<Agent>& agents, int generation, int highScore, float bestFitnessEver,
+                       uint64_t runSeed, const std::mt19937& rng, CheckpointState& out);
+
+// Same for a population of seed-chain genomes of the given topology (no weights are stored)
+void captureCheckpoint(const vector<SeedGenome>& genomes, const vector<int>& topology, int generation,
+                       int highScore, float bestFitnessEver, uint64_t runSeed, const std::mt19937& rng,
+                       CheckpointState& out);
+
+// Write a checkpoint atomically, returns false and sets error on failure
+bool writeCheckpoint(const std::string& path, const CheckpointState& state, std::string& error);
+
+// == Read-only view of a checkpoint file ==
+// The file is memory-mapped where the platform allows it (falls back to
+// reading it into memory), and on little-endian hosts agentWeights() points
+// straight into the mapping: restoring a population is one copy per agent.
+struct MappedCheckpoint {
+    const unsigned char* data = nullptr; // file contents
+    size_t size = 0; // file size (bytes)
+    bool mapped = false; // data is an mmap (else owned)
+    vector<unsigned char> owned; // fallback storage
+    vector<float> swapped; // weights converted on big-endian hosts
+
+    vector<int> topology; // decoded header
+    int population = 0, generation = 1, highScore = 0;
+    float bestFitnessEver = 0.f;
+    uint64_t runSeed = 0;
+    int floatsPerAgent = 0;
+    std::string rngState;
+    const float* weights = nullptr; // population x floatsPerAgent (null with chains)
+    const uint8_t* chains = nullptr; // chain section (null without)
+    size_t chainBytes = 0;
+
+    MappedCheckpoint() = default;
+    ~MappedCheckpoint() { close(); }
+    MappedCheckpoint(const MappedCheckpoint&) = delete;
+    MappedCheckpoint& operator=(const MappedCheckpoint&) = delete;
+
+    bool open(const std::string& path, std::string& error); // map and validate
+    void close();
+    const float* agentWeights(int i) const { return weights + (size_t)i * floatsPerAgent; }
+};
+
+// Restore a population and its training state, returns false and sets error on failure
+// With genomes, the checkpoint must hold chains: they are restored into *genomes
+// and agents is left empty. Without, a chain checkpoint is rebuilt into agents.
+bool loadCheckpoint(const std::string& path, vector<Agent>& agents, int& generation, int& highScore,
+                    float& bestFitnessEver, uint64_t& runSeed, std::mt19937& rng, std::string& error,
+                    vector<SeedGenome>* genomes = nullptr);
+
+// == Background checkpoint writer ==
+// submit() hands a captured state to a writer thread and returns at once; the
+// sim loop only pays for capturing the state. If a write is still running,
+// the newest submitted state replaces any older one that has not started.
+struct CheckpointWriter {
+    std::string path; // destination file
+    std::thread thread; // writer
+    std::mutex m; // guards everything below
+    std::condition_variable cv; // new work / work finished
+    CheckpointState pending; // next state to write
+    bool hasPending = false; // pending holds unwritten data
+    bool busy = false; // a write is in progress
+    bool stop = false; // shutting down
+    int written = 0; // checkpoints written so far
+    std::string lastError; // last failure (empty = none)
+
+    explicit CheckpointWriter(const std::string& p) : path(p) { thread = std::thread([this] { run(); }); }
+    ~CheckpointWriter();
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    // Queue state for writing; state receives a spare buffer back (no allocation in steady state)
+    void submit(CheckpointState& state);
+    // Block until every submitted state has been written
+    void flush();
+    void run(); // thread body
+};
@@ -0,0 +1,145 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Agent.hpp"
+#include "Rng.hpp"
+
+using std::vector;
+
+// == Evolution strategies (OpenAI-ES style) ==
+// Instead of copying and mutating parents, the population samples around one
+// centre parameter vector: agent 2j flies centre + sigma * eps_j and agent
+// 2j+1 centre - sigma * eps_j (antithetic pair), where eps_j is the Gaussian
+// stream noiseKey(seed, generation, j) over the real parameters. Fitness is
+// replaced by centred ranks in [-0.5, 0.5] (scale-free, robust to outliers)
+// and the centre takes one Adam step per generation along
+//
+//     g = 1 / (N sigma) * sum_j (u(2j) - u(2j+1)) eps_j
+//
+// Because eps_j is regenerated from its key, an evaluator only needs the
+// centre once per generation plus pair indices, and sends back (pair, fitness)
+// scalars; the update never looks at the agents' weights. With an odd
+// population the last agent flies the unperturbed centre.
+
+struct EvolutionStrategy {
+    float sigma = 0.1f; // perturbation scale
+    float learningRate = 0.03f; // Adam step size
+    float weightDecay = 0.005f; // L2 pull towards zero, folded into the gradient
+    float beta1 = 0.9f, beta2 = 0.999f; // Adam moment decay rates
+    uint64_t seed = 0; // keys the noise streams
+    Net center{vector<int>{9, 16, 8, 1}, 0u}; // current mean parameters (init replaces it)
+    vector<float> m, v; // Adam moments, one per real parameter
+    vector<float> grad; // last gradient estimate (real parameters, layer blocks in order)
+    vector<int> order; // rank scratch
+    vector<float> utility; // shaped fitness per agent
+    int updates = 0; // Adam steps taken
+    size_t count = 0; // real parameters (padding excluded)
+
+    // Key of pair j's noise in generation g (separate from the GA's mutation streams)
+    static uint64_t noiseKey(uint64_t seed, uint64_t generation, uint64_t pair) {
+        return mutationKey(seed ^ 0xE5E5E5E5A17E5EEDull, generation, pair);
+    }
+
+    // -- Start from a network (usually the first agent's initial brain) --
+    void init(const Net& start, uint64_t runSeed) {
+        center = start;
+        seed = runSeed;
+        count = 0;
+        for (const Layer& L : center.layers) count += L.blockSize();
+        m.assign(count, 0.f); v.assign(count, 0.f); grad.assign(count, 0.f);
+        updates = 0;
+    }
+
+    // -- Fill the population with the antithetic samples of a generation --
+    void populate(vector<Agent>& agents, int generation, ThreadPool* pool = nullptr) const {
+        PROFILE_SCOPE("es/populate");
+        const int n = (int)agents.size();
+        const int pairs = n / 2;
+        auto samplePairs = [&](int begin, int end, int) {
+            thread_local vector<float> eps;
+            eps.resize(count);
+            for (int j = begin; j < end; ++j) {
+                gaussianFill(noiseKey(seed, (uint64_t)generation, (uint64_t)j), eps.data(), (int)count);
+                Net& plus = agents[2 * j].brain;
+                Net& minus = agents[2 * j + 1].brain;
+                plus.copyWeightsFrom(center);
+                minus.copyWeightsFrom(center);
+                size_t k = 0;
+                for (const Layer& L : center.layers) {
+                    for (size_t p = L.offset; p < L.offset + L.blockSize(); ++p, ++k) {
+                        plus.params[p] += sigma * eps[k];
+                        minus.params[p] -= sigma * eps[k];
+                    }
+                }
+                agents[2 * j].fitness = agents[2 * j + 1].fitness = 0.f;
+            }
+        };
+        if (pool) pool->parallelFor(pairs, 8, samplePairs);
+        else samplePairs(0, pairs, 0);
+        if (n % 2) { // odd population: the centre itself
+            agents[n - 1].brain.copyWeightsFrom(center);
+            agents[n - 1].fitness = 0.f;
+        }
+    }
+
+    // -- Rank-shape the flown generation, step the centre and sample the next generation --
+    // Same statistics and generation bookkeeping as evolve.
+    GenStats update(vector<Agent>& agents, int& generation, float& bestFitness, ThreadPool* pool = nullptr) {
+        PROFILE_SCOPE("evolve");
+        const int n = (int)agents.size();
+        const int samples = n / 2 * 2; // perturbed agents (the centre does not enter the gradient)
+
+        GenStats stats;
+        stats.generation = generation;
+        stats.best = stats.worst = agents[0].fitness;
+        for (const Agent& a : agents) {
+            stats.best = std::max(stats.best, a.fitness);
+            stats.worst = std::min(stats.worst, a.fitness);
+            stats.avg += a.fitness;
+        }
+        stats.avg /= n;
+        if (stats.best > bestFitness) bestFitness = stats.best;
+
+        // Centred ranks: worst -0.5 ... best +0.5 (ties broken by index, so deterministic)
+        order.resize(samples);
+        for (int i = 0; i < samples; ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](int a, int b) {
+            if (agents[a].fitness != agents[b].fitness) return agents[a].fitness < agents[b].fitness;
+            return a < b;
+        });
+        utility.resize(samples);
+        for (int r = 0; r < samples; ++r) utility[order[r]] = samples > 1 ? (float)r / (samples - 1) - 0.5f : 0.f;
+
+        // Gradient: pairs accumulated serially in index order (same sum on any thread count)
+        std::fill(grad.begin(), grad.end(), 0.f);
+        thread_local vector<float> eps;
+        eps.resize(count);
+        for (int j = 0; j < samples / 2; ++j) {
+            const float w = utility[2 * j] - utility[2 * j + 1];
+            if (w == 0.f) continue;
+            gaussianFill(noiseKey(seed, (uint64_t)generation, (uint64_t)j), eps.data(), (int)count);
+            for (size_t k = 0; k < count; ++k) grad[k] += w * eps[k];
+        }
+        const float scale = samples ? 1.f / ((float)samples * sigma) : 0.f;
+
+        // Adam ascent on the centre
+        ++updates;
+        const float c1 = 1.f - std::pow(beta1, (float)updates), c2 = 1.f - std::pow(beta2, (float)updates);
+        size_t k = 0;
+        for (const Layer& L : center.layers) {
+            for (size_t p = L.offset; p < L.offset + L.blockSize(); ++p, ++k) {
+                const float g = grad[k] * scale - weightDecay * center.params[p];
+                grad[k] = g;
+                m[k] = beta1 * m[k] + (1.f - beta1) * g;
+                v[k] = beta2 * v[k] + (1.f - beta2) * g * g;
+                center.params[p] += learningRate * (m[k] / c1) / (std::sqrt(v[k] / c2) + 1e-8f);
+            }
+        }
+
+        generation++;
+        populate(agents, generation, pool);
+        return stats;
+    }
+};
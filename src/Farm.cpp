@@ -0,0 +1,384 @@
+#include "Farm.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define NRR_HAVE_UNIX_SOCKETS 1
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // macOS: SIGPIPE is ignored in FarmCoordinator::listen instead
+#endif
+#endif
+
+using namespace std;
+
+// == In-process flight of one batch ==
+void FarmEvaluator::evaluate(const vector<SeedGenome>& genomes, const FarmParams& p, vector<float>& fitness,
+                             int& score, int& steps) {
+    const size_t n = genomes.size();
+    if (squad.size() != n) squad.resize(n, Agent(NUM_INPUTS, 0u)); // weights are overwritten below
+    for (size_t i = 0; i < n; ++i) squad[i].brain.copyWeightsFrom(cache.get(genomes[i]));
+    sim.useField = p.rayTolerance >= 0.f;
+    sim.field.tolerance = p.rayTolerance;
+    sim.batch.setMode((InferenceMode)p.inference);
+    sim.sweptCollision = (p.flags & FARM_SWEPT_COLLISION) != 0;
+    sim.resetGeneration(squad, Cave(p.caveSeed));
+    while (sim.step(squad, p.dt)) {
+        if (sim.steps >= p.maxSteps) { sim.killAll(squad); break; }
+    }
+    fitness.resize(n);
+    for (size_t i = 0; i < n; ++i) fitness[i] = squad[i].fitness;
+    score = sim.score;
+    steps = sim.steps;
+}
+
+#ifdef NRR_HAVE_UNIX_SOCKETS
+// == Wire helpers ==
+static void put32(vector<uint8_t>& b, uint32_t v) { for (int i = 0; i < 4; ++i) b.push_back((uint8_t)(v >> (8 * i))); }
+static void put64(vector<uint8_t>& b, uint64_t v) { for (int i = 0; i < 8; ++i) b.push_back((uint8_t)(v >> (8 * i))); }
+static void putF(vector<uint8_t>& b, float f) { uint32_t v; memcpy(&v, &f, 4); put32(b, v); }
+static uint32_t get32(const uint8_t* p) { uint32_t v = 0; for (int i = 0; i < 4; ++i) v |= (uint32_t)p[i] << (8 * i); return v; }
+static uint64_t get64(const uint8_t* p) { uint64_t v = 0; for (int i = 0; i < 8; ++i) v |= (uint64_t)p[i] << (8 * i); return v; }
+static float getF(const uint8_t* p) { uint32_t v = get32(p); float f; memcpy(&f, &v, 4); return f; }
+
+static constexpr size_t HEADER_BYTES = 24;
+static constexpr uint32_t MAX_PAYLOAD = 1u << 28; // sanity bound on a message
+
+static bool sendAll(int fd, const uint8_t* p, size_t n) {
+    while (n > 0) {
+        ssize_t k = ::send(fd, p, n, MSG_NOSIGNAL);
+        if (k < 0 && errno == EINTR) continue;
+        if (k <= 0) return false;
+        p += k; n -= (size_t)k;
+    }
+    return true;
+}
+
+static bool recvAll(int fd, uint8_t* p, size_t n) {
+    while (n > 0) {
+        ssize_t k = ::recv(fd, p, n, 0);
+        if (k < 0 && errno == EINTR) continue;
+        if (k <= 0) return false; // closed or failed
+        p += k; n -= (size_t)k;
+    }
+    return true;
+}
+
+// Header at the front of buf (payload already appended behind it)
+static void beginMessage(vector<uint8_t>& buf, FarmMessage type, uint64_t id) {
+    buf.clear();
+    put32(buf, FARM_MAGIC); put32(buf, (uint32_t)type); put64(buf, id); put32(buf, 0); put32(buf, 0);
+}
+static void endMessage(vector<uint8_t>& buf) { // payload size into the header
+    const uint32_t size = (uint32_t)(buf.size() - HEADER_BYTES);
+    for (int i = 0; i < 4; ++i) buf[16 + i] = (uint8_t)(size >> (8 * i));
+}
+static bool sendMessage(int fd, vector<uint8_t>& buf) {
+    endMessage(buf);
+    return sendAll(fd, buf.data(), buf.size());
+}
+static bool recvMessage(int fd, FarmMessage& type, uint64_t& id, vector<uint8_t>& payload) {
+    uint8_t h[HEADER_BYTES];
+    if (!recvAll(fd, h, HEADER_BYTES) || get32(h) != FARM_MAGIC) return false;
+    type = (FarmMessage)get32(h + 4);
+    id = get64(h + 8);
+    const uint32_t size = get32(h + 16);
+    if (size > MAX_PAYLOAD) return false;
+    payload.resize(size);
+    return size == 0 || recvAll(fd, payload.data(), size);
+}
+
+static bool socketAddress(const string& path, sockaddr_un& addr, string& error) {
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) { error = "socket path too long: " + path; return false; }
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+// == Worker ==
+int runFarmWorker(const string& path, int dieAfter) {
+    sockaddr_un addr;
+    string error;
+    if (!socketAddress(path, addr, error)) { fprintf(stderr, "farm worker: %s\n", error.c_str()); return 1; }
+    int fd = -1;
+    for (int attempt = 0; attempt < 100; ++attempt) { // the coordinator may still be starting
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && ::connect(fd, (const sockaddr*)&addr, sizeof(addr)) == 0) break;
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+        this_thread::sleep_for(chrono::milliseconds(100));
+    }
+    if (fd < 0) { fprintf(stderr, "farm worker: cannot connect to %s\n", path.c_str()); return 1; }
+
+    vector<uint8_t> buf, payload;
+    beginMessage(buf, FarmMessage::Hello, 0);
+    put32(buf, FARM_VERSION);
+    if (!sendMessage(fd, buf)) { ::close(fd); return 1; }
+
+    FarmEvaluator eval;
+    vector<SeedGenome> genomes;
+    vector<float> fitness;
+    int served = 0;
+    for (;;) {
+        FarmMessage type; uint64_t id;
+        if (!recvMessage(fd, type, id, payload)) break; // coordinator gone
+        if (type == FarmMessage::Shutdown) break;
+        if (type != FarmMessage::Batch || payload.size() < 28) { fprintf(stderr, "farm worker: bad message\n"); break; }
+        if (dieAfter > 0 && ++served >= dieAfter) _exit(3); // simulated crash, batch unanswered
+
+        FarmParams p;
+        const uint8_t* q = payload.data();
+        p.caveSeed = get32(q); p.dt = getF(q + 4); p.maxSteps = (int32_t)get32(q + 8);
+        p.rayTolerance = getF(q + 12); p.inference = get32(q + 16); p.flags = get32(q + 20);
+        const uint32_t count = get32(q + 24);
+        genomes.resize(count);
+        size_t pos = 28;
+        bool ok = true;
+        for (uint32_t i = 0; i < count && ok; ++i) ok = SeedGenome::read(payload.data(), payload.size(), pos, genomes[i]);
+        if (!ok) { fprintf(stderr, "farm worker: truncated batch\n"); break; }
+
+        int score = 0, steps = 0;
+        eval.evaluate(genomes, p, fitness, score, steps);
+        beginMessage(buf, FarmMessage::Result, id);
+        put32(buf, (uint32_t)score); put32(buf, (uint32_t)steps); put32(buf, count);
+        for (float f : fitness) putF(buf, f);
+        if (!sendMessage(fd, buf)) break;
+    }
+    ::close(fd);
+    return 0;
+}
+
+// == Coordinator ==
+bool FarmCoordinator::listen(const string& socketPath, string& error) {
+    signal(SIGPIPE, SIG_IGN); // a dead worker shows up as a failed send, not a signal
+    sockaddr_un addr;
+    if (!socketAddress(socketPath, addr, error)) return false;
+    ::unlink(socketPath.c_str());
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0 || ::fcntl(listenFd, F_SETFL, O_NONBLOCK) != 0 || ::bind(listenFd, (const sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(listenFd, 64) != 0) {
+        error = "cannot listen on " + socketPath + ": " + strerror(errno);
+        if (listenFd >= 0) ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    path = socketPath;
+    return true;
+}
+
+int FarmCoordinator::readyWorkers() const {
+    int n = 0;
+    for (const Conn& c : workers) n += c.ready;
+    return n;
+}
+
+void FarmCoordinator::acceptWorkers() {
+    for (;;) {
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) return; // nothing waiting
+        if (::fcntl(fd, F_SETFL, O_NONBLOCK) != 0) { ::close(fd); continue; }
+        Conn c; c.fd = fd;
+        c.accepted = chrono::steady_clock::now(); // a worker until it fails to say Hello in time
+        workers.push_back(std::move(c));
+    }
+}
+
+// Close a worker and queue its unanswered batches again
+void FarmCoordinator::dropWorker(size_t w) {
+    Conn& c = workers[w];
+    for (uint64_t id : c.inFlight) {
+        auto it = batchOf.find(id);
+        if (it == batchOf.end()) continue;
+        if (!batches[it->second].done) { pending.push_front(it->second); ++resubmitted; }
+        batchOf.erase(it);
+    }
+    if (c.ready) ++workersLost;
+    ::close(c.fd);
+    workers.erase(workers.begin() + w);
+}
+
+bool FarmCoordinator::flush(Conn& c) {
+    while (c.sent < c.out.size()) {
+        ssize_t k = ::send(c.fd, c.out.data() + c.sent, c.out.size() - c.sent, MSG_NOSIGNAL);
+        if (k < 0 && errno == EINTR) continue;
+        if (k < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true; // socket full, poll for POLLOUT
+        if (k <= 0) return false;
+        c.sent += (size_t)k;
+    }
+    c.out.clear(); c.sent = 0;
+    return true;
+}
+
+bool FarmCoordinator::receive(Conn& c) {
+    uint8_t buf[1 << 14];
+    for (;;) {
+        ssize_t k = ::recv(c.fd, buf, sizeof(buf), 0);
+        if (k < 0 && errno == EINTR) continue;
+        if (k < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break; // all read
+        if (k <= 0) return false; // closed or failed
+        c.in.insert(c.in.end(), buf, buf + k);
+    }
+    size_t pos = 0;
+    while (c.in.size() - pos >= HEADER_BYTES) { // whole messages only
+        const uint8_t* h = c.in.data() + pos;
+        const uint32_t size = get32(h + 16);
+        if (get32(h) != FARM_MAGIC || size > MAX_PAYLOAD) return false;
+        if (c.in.size() - pos < HEADER_BYTES + size) break; // rest still on the way
+        const FarmMessage type = (FarmMessage)get32(h + 4);
+        const uint64_t id = get64(h + 8);
+        const uint8_t* payload = h + HEADER_BYTES;
+        pos += HEADER_BYTES + size;
+        if (!c.ready) { // the first message must be a Hello of this version
+            if (type != FarmMessage::Hello || size < 4 || get32(payload) != FARM_VERSION) return false;
+            c.ready = true;
+            ++workersSeen;
+        } else {
+            if (type != FarmMessage::Result || size < 12) return false;
+            c.inFlight.erase(std::remove(c.inFlight.begin(), c.inFlight.end(), id), c.inFlight.end());
+            results.push_back(Received{id, vector<uint8_t>(payload, payload + size)});
+        }
+    }
+    c.in.erase(c.in.begin(), c.in.begin() + pos);
+    return true;
+}
+
+void FarmCoordinator::pollWorkers(int timeoutMs) {
+    vector<pollfd> fds;
+    fds.push_back(pollfd{listenFd, POLLIN, 0});
+    for (const Conn& c : workers) fds.push_back(pollfd{c.fd, (short)(POLLIN | (c.out.empty() ? 0 : POLLOUT)), 0});
+    const int n = ::poll(fds.data(), fds.size(), timeoutMs);
+    const auto now = chrono::steady_clock::now();
+    for (size_t k = fds.size() - 1; k >= 1; --k) { // back to front: drops keep earlier indices valid
+        Conn& c = workers[k - 1];
+        const short ev = n > 0 ? fds[k].revents : 0;
+        bool keep = true;
+        if (ev & POLLOUT) keep = flush(c);
+        if (keep && (ev & (POLLIN | POLLHUP | POLLERR))) keep = receive(c); // died or spoke nonsense: dropped
+        if (keep && !c.ready && chrono::duration<double>(now - c.accepted).count() > helloTimeout) keep = false;
+        if (!keep) dropWorker(k - 1); // its batches go to the others
+    }
+    if (n > 0 && (fds[0].revents & POLLIN)) acceptWorkers();
+}
+
+bool FarmCoordinator::sendBatch(Conn& c, int b, const vector<SeedGenome>& genomes, const FarmParams& p) {
+    const uint64_t id = nextId++;
+    beginMessage(tx, FarmMessage::Batch, id);
+    put32(tx, p.caveSeed); putF(tx, p.dt); put32(tx, (uint32_t)p.maxSteps); putF(tx, p.rayTolerance);
+    put32(tx, p.inference); put32(tx, p.flags);
+    put32(tx, (uint32_t)(batches[b].end - batches[b].begin));
+    for (int i = batches[b].begin; i < batches[b].end; ++i) genomes[i].write(tx);
+    endMessage(tx);
+    c.out.insert(c.out.end(), tx.begin(), tx.end()); // written as the socket drains
+    c.inFlight.push_back(id);
+    batchOf[id] = b;
+    ++batchesSent;
+    return flush(c);
+}
+
+bool FarmCoordinator::waitForWorkers(int count, string& error) {
+    auto t0 = chrono::steady_clock::now();
+    while (readyWorkers() < count) {
+        if (chrono::duration<double>(chrono::steady_clock::now() - t0).count() > workerWait) {
+            error = "only " + to_string(readyWorkers()) + " of " + to_string(count) + " farm workers connected";
+            return false;
+        }
+        pollWorkers(100);
+    }
+    return true;
+}
+
+bool FarmCoordinator::evaluate(const vector<SeedGenome>& genomes, const FarmParams& p, vector<float>& fitness,
+                               int& score, int& steps, string& error) {
+    const int n = (int)genomes.size();
+    fitness.assign(n, 0.f);
+    score = 0; steps = 0;
+    batches.clear(); pending.clear(); batchOf.clear(); results.clear();
+    for (Conn& c : workers) c.inFlight.clear();
+    for (int b = 0; b < n; b += batchSize) {
+        batches.push_back(Batch{b, std::min(n, b + batchSize), false});
+        pending.push_back((int)batches.size() - 1);
+    }
+    int remaining = (int)batches.size();
+    auto idleSince = chrono::steady_clock::now(); // last moment a worker was connected
+
+    while (remaining > 0) {
+        // Keep every worker's pipeline full (queued, never waiting on a socket)
+        for (size_t w = 0; w < workers.size();) {
+            bool alive = true;
+            while (alive && workers[w].ready && !pending.empty() && (int)workers[w].inFlight.size() < pipeline) {
+                const int b = pending.front();
+                pending.pop_front();
+                if (batches[b].done) continue;
+                alive = sendBatch(workers[w], b, genomes, p);
+            }
+            if (alive) ++w;
+            else dropWorker(w); // requeues the batch just queued as well
+        }
+        if (readyWorkers() == 0) {
+            if (chrono::duration<double>(chrono::steady_clock::now() - idleSince).count() > workerWait) {
+                error = "no farm worker connected to " + path;
+                return false;
+            }
+        } else {
+            idleSince = chrono::steady_clock::now();
+        }
+
+        // Write, read and accept, then take in the results
+        pollWorkers(100);
+        for (const Received& r : results) {
+            auto it = batchOf.find(r.id);
+            if (it == batchOf.end()) continue; // not ours (stale)
+            Batch& b = batches[it->second];
+            batchOf.erase(it);
+            const uint32_t count = get32(r.payload.data() + 8);
+            if (b.done || count != (uint32_t)(b.end - b.begin) || r.payload.size() < 12 + 4 * (size_t)count) continue;
+            score = std::max(score, (int)get32(r.payload.data()));
+            steps = std::max(steps, (int)get32(r.payload.data() + 4));
+            for (uint32_t i = 0; i < count; ++i) fitness[b.begin + i] = getF(r.payload.data() + 12 + 4 * i);
+            b.done = true;
+            --remaining;
+        }
+        results.clear();
+    }
+    return true;
+}
+
+void FarmCoordinator::shutdown() {
+    for (Conn& c : workers) {
+        if (c.ready && c.out.empty()) { // best effort: a worker also exits when the socket closes
+            beginMessage(tx, FarmMessage::Shutdown, 0);
+            sendMessage(c.fd, tx);
+        }
+        ::close(c.fd);
+    }
+    workers.clear();
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        ::unlink(path.c_str());
+        listenFd = -1;
+    }
+}
+#else // no Unix-domain sockets: the farm is unavailable, in-process training is unaffected
+
+int runFarmWorker(const string&, int) {
+    fprintf(stderr, "farm worker: this platform has no Unix-domain sockets\n");
+    return 1;
+}
+bool FarmCoordinator::listen(const string&, string& error) { error = "this platform has no Unix-domain sockets"; return false; }
+bool FarmCoordinator::waitForWorkers(int, string& error) { error = "no farm"; return false; }
+bool FarmCoordinator::evaluate(const vector<SeedGenome>&, const FarmParams&, vector<float>&, int&, int&, string& error) {
+    error = "no farm";
+    return false;
+}
+void FarmCoordinator::shutdown() {}
+
+#endif
@@ -0,0 +1,124 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Sim.hpp"
+#include "SeedGenome.hpp"
+
+using std::vector;
+
+// == Evaluation farm over Unix-domain sockets ==
+// A coordinator listens on a socket path; worker processes (tools/farm_worker,
+// any number, started before or during the run) connect to it. Each
+// generation the coordinator cuts the population into batches of seed-chain
+// genomes (see SeedGenome) plus the cave seed and flight parameters, keeps a
+// few batches in flight per worker so none idles between results, and
+// collects one fitness per genome. A worker that disconnects or dies has its
+// unfinished batches queued again for the others. Flights are independent,
+// so results match an in-process run whatever the split or the worker count.
+// The coordinator never blocks on one connection: sockets are non-blocking,
+// incoming bytes are parsed as whole messages arrive, batches are queued per
+// worker and written as the socket drains, and a connection that does not
+// say Hello within helloTimeout is closed.
+//
+// Messages: 24-byte header (u32 magic "NRRF", u32 type, u64 batch id,
+// u32 payload bytes, u32 reserved), then the payload; all little-endian.
+//   Hello    worker -> coordinator  u32 protocol version
+//   Batch    coordinator -> worker  FarmParams (24 bytes), u32 count, count genomes (SeedGenome::write)
+//   Result   worker -> coordinator  i32 score, i32 steps, u32 count, count f32 fitness
+//   Shutdown coordinator -> worker  empty
+
+static constexpr uint32_t FARM_MAGIC = 0x4652524E; // "NRRF" as little-endian bytes
+static constexpr uint32_t FARM_VERSION = 2; // 2: FarmParams flags
+
+enum class FarmMessage : uint32_t { Hello = 1, Batch = 2, Result = 3, Shutdown = 4 };
+
+// Everything a worker needs to fly a batch besides the genomes
+struct FarmParams {
+    uint32_t caveSeed = 0; // Cave(caveSeed)
+    float dt = 1.f / 60.f; // fixed timestep
+    int32_t maxSteps = 36000; // steps before a flight is cut off
+    float rayTolerance = 0.05f; // sensing field tolerance (< 0 = march every ray)
+    uint32_t inference = 0; // InferenceMode
+    uint32_t flags = 0; // FARM_SWEPT_COLLISION
+};
+
+static constexpr uint32_t FARM_SWEPT_COLLISION = 1; // Simulation::sweptCollision
+
+// Fly genomes on one cave in this process (what a worker does with a batch)
+struct FarmEvaluator {
+    GenomeCache cache{vector<int>{NUM_INPUTS, 16, 8, 1}, 1024}; // parents of the last batches stay warm
+    Simulation sim;
+    vector<Agent> squad;
+
+    // fitness[i] of genomes[i]; score and steps of the flight
+    void evaluate(const vector<SeedGenome>& genomes, const FarmParams& p, vector<float>& fitness, int& score, int& steps);
+};
+
+// -- Worker side: connect to path and serve batches until shut down (returns the exit code) --
+// dieAfter > 0 makes the worker exit without answering its dieAfter-th batch (resubmission testing).
+int runFarmWorker(const std::string& path, int dieAfter = 0);
+
+struct FarmCoordinator {
+    struct Conn {
+        int fd = -1;
+        bool ready = false; // Hello received: batches may be sent
+        std::chrono::steady_clock::time_point accepted; // Hello deadline starts here
+        vector<uint8_t> in; // received bytes not parsed yet
+        vector<uint8_t> out; // queued bytes, out[sent..] not written yet
+        size_t sent = 0;
+        vector<uint64_t> inFlight; // batch ids queued or sent and not answered
+    };
+    struct Received {
+        uint64_t id = 0; // batch id
+        vector<uint8_t> payload; // Result payload
+    };
+    struct Batch {
+        int begin = 0, end = 0; // genome range
+        bool done = false;
+    };
+
+    std::string path; // socket path
+    int listenFd = -1;
+    vector<Conn> workers;
+    int batchSize = 32; // genomes per batch
+    int pipeline = 2; // batches in flight per worker
+    double workerWait = 30.0; // seconds to wait while no worker is connected
+    double helloTimeout = 5.0; // seconds a new connection has to say Hello
+    uint64_t batchesSent = 0, resubmitted = 0, workersLost = 0; // statistics
+    int workersSeen = 0; // connections accepted
+
+    ~FarmCoordinator() { shutdown(); }
+
+    // Create the socket (an existing file at path is replaced); false with error set on failure
+    bool listen(const std::string& socketPath, std::string& error);
+
+    // Block until at least count workers are connected (or the wait runs out)
+    bool waitForWorkers(int count, std::string& error);
+
+    // Fitness of every genome on the farm; score and steps are the longest flight's
+    bool evaluate(const vector<SeedGenome>& genomes, const FarmParams& p, vector<float>& fitness,
+                  int& score, int& steps, std::string& error);
+
+    void shutdown(); // tell the workers to exit, close and unlink the socket
+    int readyWorkers() const; // connections that said Hello
+
+private:
+    uint64_t nextId = 1;
+    vector<Batch> batches;
+    std::deque<int> pending; // batch indices waiting for a worker
+    std::unordered_map<uint64_t, int> batchOf; // in-flight id -> batch index
+    vector<uint8_t> tx; // message buffer
+    vector<Received> results; // Result messages collected by pollWorkers
+
+    void acceptWorkers();
+    void dropWorker(size_t w);
+    bool flush(Conn& c); // write queued bytes until the socket is full, false on failure
+    bool receive(Conn& c); // read what has arrived and parse Hello / Result, false to drop
+    void pollWorkers(int timeoutMs); // one round of accepting, writing and reading
+    bool sendBatch(Conn& c, int b, const vector<SeedGenome>& genomes, const FarmParams& p);
+};
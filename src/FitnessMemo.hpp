@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include "NeuralNet.hpp"
+#include "Rng.hpp"
+
+// == Fitness memo: (genome, cave, sim parameters) -> outcome ==
+// A flight is a pure function of the brain's weights, the cave layout and the
+// simulation parameters: agents never interact, and the shared score only
+// depends on how many steps have passed. Elites copied unchanged by evolve
+// (and any other repeated genome) can therefore take their fitness from an
+// earlier flight of the same cave instead of flying it again.
+
+// 64-bit hash of a network's topology and weights (bit patterns, so -0 != +0)
+inline uint64_t genomeHash(const Net& net) {
+    uint64_t h = mix64(net.layers.size());
+    for (const Layer& L : net.layers) {
+        h = mix64(h ^ ((uint64_t)L.inSize << 32 | (uint32_t)L.outSize));
+        const float* p = net.params.data() + L.offset;
+        const size_t n = L.blockSize();
+        size_t k = 0;
+        for (; k + 1 < n; k += 2) { // two weights per mix
+            uint64_t bits; memcpy(&bits, p + k, sizeof(bits));
+            h = mix64(h ^ bits);
+        }
+        if (k < n) { uint32_t bits; memcpy(&bits, p + k, sizeof(bits)); h = mix64(h ^ bits); }
+    }
+    return h;
+}
+
+struct MemoKey {
+    uint64_t genome = 0; // genomeHash of the brain
+    uint64_t cave = 0; // Cave::seed
+    uint64_t params = 0; // hash of everything else the flight depends on (see Simulation::memoParams)
+    bool operator==(const MemoKey& o) const { return genome == o.genome && cave == o.cave && params == o.params; }
+};
+
+struct MemoKeyHash {
+    size_t operator()(const MemoKey& k) const { return (size_t)streamKey(k.genome, k.cave, k.params); }
+};
+
+struct MemoEntry {
+    float fitness = 0.f; // final fitness
+    float shaping = 0.f, survival = 0.f; // fitness components (see Simulation::deathFitness)
+    int deathScore = 0; // shared score at death
+    int deathStep = 0; // steps flown, the generation lasts at least this long
+    int lastUsed = 0; // generation stamp of the last store or hit
+};
+
+struct FitnessMemo {
+    std::unordered_map<MemoKey, MemoEntry, MemoKeyHash> entries;
+    size_t capacity = 1 << 18; // entries kept before the least recently used generations are dropped
+    int stamp = 0; // current generation
+    uint64_t lookups = 0, hits = 0, stores = 0, evicted = 0; // statistics
+
+    bool find(const MemoKey& key, MemoEntry& out) {
+        ++lookups;
+        auto it = entries.find(key);
+        if (it == entries.end()) return false;
+        it->second.lastUsed = stamp;
+        out = it->second;
+        ++hits;
+        return true;
+    }
+
+    void store(const MemoKey& key, const MemoEntry& outcome) {
+        MemoEntry& e = entries[key];
+        e = outcome;
+        e.lastUsed = stamp;
+        ++stores;
+    }
+
+    // -- Start a new generation, dropping the stalest entries once over capacity --
+    void nextGeneration() {
+        ++stamp;
+        while (entries.size() > capacity) {
+            int oldest = stamp;
+            for (const auto& kv : entries) oldest = std::min(oldest, kv.second.lastUsed);
+            for (auto it = entries.begin(); it != entries.end();) {
+                if (it->second.lastUsed == oldest) { it = entries.erase(it); ++evicted; }
+                else ++it;
+            }
+        }
+    }
+
+    double hitRate() const { return lookups ? (double)hits / (double)lookups : 0.0; }
+};
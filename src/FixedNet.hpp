@@ -0,0 +1,95 @@
+#pragma once
+#include <array>
+#include <cstring>
+#include <vector>
+#include "NeuralNet.hpp"
+
+using std::vector;
+
+// == Network with compile-time topology ==
+// FixedNet<9, 16, 8, 1> is the same network as Net({9, 16, 8, 1}) with every
+// layer size a constant: the parameters live in one std::array, the forward
+// pass is a chain of fixed-trip-count loops the compiler can fully unroll,
+// and the activations stay in small stack arrays (registers for this size).
+//
+// Parameters are Net's layer blocks without the alignment padding: per layer
+// row-major weights [out][in] followed by the out biases. Forward results and
+// mutations match Net bit for bit (checked by tools/fixednet_check), so the
+// two can be swapped freely.
+template <int... Sizes>
+struct FixedNet {
+    static_assert(sizeof...(Sizes) >= 2, "FixedNet needs an input and an output layer");
+    static constexpr int NUM_SIZES = (int)sizeof...(Sizes); // layer sizes, input included
+    static constexpr int NUM_LAYERS = NUM_SIZES - 1; // weight layers
+    static constexpr std::array<int, NUM_SIZES> SIZES = {Sizes...};
+    static constexpr int INPUTS = SIZES[0];
+    static constexpr int OUTPUTS = SIZES[NUM_SIZES - 1];
+
+    // Start of layer l's block in params
+    static constexpr int offsetOf(int l) {
+        int off = 0;
+        for (int i = 0; i < l; ++i) off += SIZES[i + 1] * (SIZES[i] + 1);
+        return off;
+    }
+    static constexpr int PARAM_COUNT = offsetOf(NUM_LAYERS); // all weights and biases
+
+    alignas(64) std::array<float, PARAM_COUNT> params{}; // packed blocks
+
+    FixedNet() = default;
+    explicit FixedNet(const Net& net) { fromNet(net); }
+
+    // -- Same weights as a dynamic Net (returns false if the topology differs) --
+    bool fromNet(const Net& net) {
+        if ((int)net.layers.size() != NUM_LAYERS) return false;
+        for (int l = 0; l < NUM_LAYERS; ++l) {
+            if (net.layers[l].inSize != SIZES[l] || net.layers[l].outSize != SIZES[l + 1]) return false;
+        }
+        for (int l = 0; l < NUM_LAYERS; ++l) {
+            memcpy(params.data() + offsetOf(l), net.params.data() + net.layers[l].offset,
+                   net.layers[l].blockSize() * sizeof(float));
+        }
+        return true;
+    }
+
+    // -- Dynamic Net with the same topology and weights --
+    Net toNet() const {
+        Net net(vector<int>{Sizes...}, 0u); // weights are overwritten below
+        for (int l = 0; l < NUM_LAYERS; ++l) {
+            memcpy(net.params.data() + net.layers[l].offset, params.data() + offsetOf(l),
+                   net.layers[l].blockSize() * sizeof(float));
+        }
+        return net;
+    }
+
+    // -- Forward pass (x holds INPUTS floats), returns the first output --
+    float forward(const float* x) const { return layer<0>(x); }
+    float forward(const vector<float>& x) const { return layer<0>(x.data()); }
+    bool upDecision(const vector<float>& x) const { return forward(x) > 0.f; }
+
+    // -- Mutation: same draws and result as Net::mutate with the same key --
+    void mutate(uint64_t key, float sigma, float prob) {
+        if (prob <= 0.f || sigma == 0.f) return;
+        thread_local vector<size_t> hits; // parameters hit by this mutation
+        thread_local vector<float> noise; // their Gaussian perturbations
+        mutationIndices(key, prob, PARAM_COUNT, hits);
+        noise.resize(hits.size());
+        mutationNoise(key, noise.data(), (int)noise.size());
+        for (size_t k = 0; k < hits.size(); ++k) params[hits[k]] += sigma * noise[k];
+    }
+
+private:
+    template <int L>
+    float layer(const float* in) const {
+        constexpr int IN = SIZES[L], OUT = SIZES[L + 1];
+        const float* w = params.data() + offsetOf(L); // row-major weights
+        const float* b = w + OUT * IN; // biases
+        float out[OUT];
+        for (int n = 0; n < OUT; ++n) { // fixed trip counts: unrolled by the compiler
+            float s = b[n];
+            for (int i = 0; i < IN; ++i) s += w[n * IN + i] * in[i];
+            out[n] = Net::act(s);
+        }
+        if constexpr (L + 1 == NUM_LAYERS) return out[0];
+        else return layer<L + 1>(out);
+    }
+};
@@ -0,0 +1,562 @@
+#include "Headless.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Sim.hpp"
+#include "Checkpoint.hpp"
+#include "MultiCaveEval.hpp"
+#include "Islands.hpp"
+#include "SeedGenome.hpp"
+#include "Farm.hpp"
+#include "Telemetry.hpp"
+#include "EvolutionStrategy.hpp"
+
+using namespace std;
+
+static const int CHAIN_CHUNK = 256; // --seed-chains: genomes rebuilt and flown together
+
+// == Command line ==
+static void printUsage(const char* exe) {
+    fprintf(stderr,
+        "usage: %s --headless [--generations N] [--seed S] [--out stats.csv]\n"
+        "                      [--dt SECONDS] [--max-steps N] [--ray-tolerance PX]\n"
+        "                      [--threads N] [--population N] [--ccd] [--step-scale 1|2]\n"
+        "                      [--checkpoint FILE] [--checkpoint-every N] [--resume FILE]\n"
+        "                      [--trace trace.json] [--inference exact|fast|int8]\n"
+        "                      [--cave-cycle N] [--no-memo] [--caves K] [--keep F]\n"
+        "                      [--islands M] [--migrate-every K] [--migrants N]\n"
+        "                      [--topology ring|full] [--async-migration] [--seed-chains]\n"
+        "                      [--farm SOCKET] [--farm-workers N] [--farm-batch N]\n"
+        "                      [--telemetry FILE] [--telemetry-agents]\n"
+        "                      [--optimizer ga|es] [--es-sigma S] [--es-lr R] [--target-score N]\n"
+        "The fitness memo (off with --no-memo) needs repeated caves: it is used only\n"
+        "with --cave-cycle N > 0, where elites fly the same cave again.\n", exe);
+}
+
+bool wantsHeadless(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--headless") == 0) return true;
+    }
+    return false;
+}
+
+bool parseHeadlessArgs(int argc, char** argv, HeadlessOptions& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc; // next token available as value
+        if (strcmp(arg, "--headless") == 0) {
+            continue;
+        } else if (strcmp(arg, "--generations") == 0 && hasValue) {
+            opt.generations = atoi(argv[++i]);
+        } else if (strcmp(arg, "--seed") == 0 && hasValue) {
+            opt.seed = (unsigned)strtoul(argv[++i], nullptr, 10);
+            opt.seedSet = true;
+        } else if (strcmp(arg, "--out") == 0 && hasValue) {
+            opt.outPath = argv[++i];
+        } else if (strcmp(arg, "--dt") == 0 && hasValue) {
+            opt.dt = (float)atof(argv[++i]);
+        } else if (strcmp(arg, "--max-steps") == 0 && hasValue) {
+            opt.maxSteps = atoi(argv[++i]);
+        } else if (strcmp(arg, "--population") == 0 && hasValue) {
+            opt.population = atoi(argv[++i]);
+            opt.populationSet = true;
+        } else if (strcmp(arg, "--threads") == 0 && hasValue) {
+            opt.threads = atoi(argv[++i]);
+        } else if (strcmp(arg, "--ray-tolerance") == 0 && hasValue) {
+            opt.rayTolerance = (float)atof(argv[++i]);
+        } else if (strcmp(arg, "--ccd") == 0) {
+            opt.sweptCollision = true;
+        } else if (strcmp(arg, "--step-scale") == 0 && hasValue) {
+            opt.stepScale = atoi(argv[++i]);
+        } else if (strcmp(arg, "--checkpoint") == 0 && hasValue) {
+            opt.checkpointPath = argv[++i];
+        } else if (strcmp(arg, "--checkpoint-every") == 0 && hasValue) {
+            opt.checkpointEvery = atoi(argv[++i]);
+        } else if (strcmp(arg, "--resume") == 0 && hasValue) {
+            opt.resumePath = argv[++i];
+        } else if (strcmp(arg, "--inference") == 0 && hasValue) {
+            const char* m = argv[++i];
+            if (strcmp(m, "exact") == 0) opt.inference = InferenceMode::Exact;
+            else if (strcmp(m, "fast") == 0) opt.inference = InferenceMode::FastTanh;
+            else if (strcmp(m, "int8") == 0) opt.inference = InferenceMode::Int8;
+            else { fprintf(stderr, "unknown inference mode: %s\n", m); printUsage(argv[0]); return false; }
+        } else if (strcmp(arg, "--cave-cycle") == 0 && hasValue) {
+            opt.caveCycle = atoi(argv[++i]);
+        } else if (strcmp(arg, "--caves") == 0 && hasValue) {
+            opt.caves = atoi(argv[++i]);
+        } else if (strcmp(arg, "--keep") == 0 && hasValue) {
+            opt.keep = (float)atof(argv[++i]);
+        } else if (strcmp(arg, "--islands") == 0 && hasValue) {
+            opt.islands = atoi(argv[++i]);
+        } else if (strcmp(arg, "--migrate-every") == 0 && hasValue) {
+            opt.migrateEvery = atoi(argv[++i]);
+        } else if (strcmp(arg, "--migrants") == 0 && hasValue) {
+            opt.migrants = atoi(argv[++i]);
+        } else if (strcmp(arg, "--topology") == 0 && hasValue) {
+            const char* t = argv[++i];
+            if (strcmp(t, "ring") == 0) opt.fullTopology = false;
+            else if (strcmp(t, "full") == 0) opt.fullTopology = true;
+            else { fprintf(stderr, "unknown topology: %s\n", t); printUsage(argv[0]); return false; }
+        } else if (strcmp(arg, "--async-migration") == 0) {
+            opt.asyncMigration = true;
+        } else if (strcmp(arg, "--seed-chains") == 0) {
+            opt.seedChains = true;
+        } else if (strcmp(arg, "--farm") == 0 && hasValue) {
+            opt.farmPath = argv[++i];
+            opt.seedChains = true; // genomes travel as seed chains
+        } else if (strcmp(arg, "--farm-workers") == 0 && hasValue) {
+            opt.farmWorkers = atoi(argv[++i]);
+        } else if (strcmp(arg, "--farm-batch") == 0 && hasValue) {
+            opt.farmBatch = atoi(argv[++i]);
+        } else if (strcmp(arg, "--no-memo") == 0) {
+            opt.memo = false;
+        } else if (strcmp(arg, "--telemetry") == 0 && hasValue) {
+            opt.telemetryPath = argv[++i];
+        } else if (strcmp(arg, "--telemetry-agents") == 0) {
+            opt.telemetryAgents = true;
+        } else if (strcmp(arg, "--optimizer") == 0 && hasValue) {
+            const char* o = argv[++i];
+            if (strcmp(o, "ga") == 0) opt.es = false;
+            else if (strcmp(o, "es") == 0) opt.es = true;
+            else { fprintf(stderr, "unknown optimizer: %s\n", o); printUsage(argv[0]); return false; }
+        } else if (strcmp(arg, "--es-sigma") == 0 && hasValue) {
+            opt.esSigma = (float)atof(argv[++i]);
+        } else if (strcmp(arg, "--es-lr") == 0 && hasValue) {
+            opt.esLearningRate = (float)atof(argv[++i]);
+        } else if (strcmp(arg, "--target-score") == 0 && hasValue) {
+            opt.targetScore = atoi(argv[++i]);
+        } else if (strcmp(arg, "--trace") == 0 && hasValue) {
+            opt.tracePath = argv[++i];
+        } else {
+            fprintf(stderr, "unknown or incomplete option: %s\n", arg);
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    if (opt.generations <= 0 || opt.dt <= 0.f || opt.maxSteps <= 0 || opt.population < 2 * ELITE_COUNT
+        || opt.checkpointEvery <= 0 || opt.caveCycle < 0 || opt.caves <= 0 || opt.keep <= 0.f || opt.keep > 1.f
+        || opt.islands <= 0 || opt.migrateEvery <= 0 || opt.migrants < 0 || opt.farmWorkers <= 0 || opt.farmBatch <= 0
+        || opt.esSigma <= 0.f || opt.esLearningRate <= 0.f || opt.targetScore < 0 || opt.stepScale <= 0) {
+        printUsage(argv[0]);
+        return false;
+    }
+    if (opt.stepScale > MAX_STEP_SCALE) { // networks decide less often: outcomes drift beyond it
+        fprintf(stderr, "--step-scale: at most %d (larger steps change what trained networks fly, see tools/ccd_check)\n", MAX_STEP_SCALE);
+        return false;
+    }
+    if (!opt.farmPath.empty() && (opt.caves > 1 || opt.islands > 1)) {
+        fprintf(stderr, "--farm flies one cave per generation for a single population; drop --caves/--islands\n");
+        return false;
+    }
+    if (opt.stepScale > 1) { // same simulated time in K times fewer steps
+        opt.dt *= (float)opt.stepScale;
+        opt.maxSteps = (opt.maxSteps + opt.stepScale - 1) / opt.stepScale;
+        opt.sweptCollision = true; // no tunnelling through walls between the far apart steps
+    }
+    return true;
+}
+
+// == Island model: M populations on their own threads, reported together ==
+static int runIslands(const HeadlessOptions& opt, unsigned seed) {
+    if (!opt.checkpointPath.empty() || !opt.resumePath.empty()) {
+        fprintf(stderr, "--islands: checkpoints hold a single population, drop --checkpoint/--resume\n");
+        return 1;
+    }
+    // Each island is one single-threaded Simulation flying a new cave every
+    // generation, evaluated in process: refuse options it would ignore
+    const char* ignored = opt.caves > 1 ? "--caves" : opt.caveCycle > 0 ? "--cave-cycle"
+                        : opt.seedChains ? "--seed-chains"
+                        : !opt.memo ? "--no-memo" : opt.threads != 0 ? "--threads"
+                        : opt.targetScore > 0 ? "--target-score" : nullptr;
+    if (ignored) {
+        fprintf(stderr, "--islands: %s is not supported per island (islands run one thread each, without the memo)\n", ignored);
+        return 1;
+    }
+    FILE* out = nullptr; // optional stats file
+    if (!opt.outPath.empty()) {
+        out = fopen(opt.outPath.c_str(), "w");
+        if (!out) { fprintf(stderr, "cannot open %s\n", opt.outPath.c_str()); return 1; }
+        fprintf(out, "generation,best,avg,worst,score,steps,seconds\n");
+    }
+
+    Telemetry telemetry; // echoes the generation lines, optionally writes the columnar file
+    std::string error;
+    if (!telemetry.open(opt.telemetryPath, error)) {
+        fprintf(stderr, "telemetry: %s\n", error.c_str());
+        if (out) fclose(out);
+        return 1;
+    }
+    if (opt.telemetryAgents) fprintf(stderr, "--islands: telemetry has generation rows only\n");
+
+    IslandOptions io;
+    io.islands = opt.islands;
+    io.population = opt.population;
+    io.generations = opt.generations;
+    io.migrateEvery = opt.migrateEvery;
+    io.migrants = opt.migrants;
+    io.topology = opt.fullTopology ? MigrationTopology::Full : MigrationTopology::Ring;
+    io.syncMigration = !opt.asyncMigration;
+    io.dt = opt.dt;
+    io.maxSteps = opt.maxSteps;
+    io.useField = opt.rayTolerance >= 0.f;
+    io.rayTolerance = opt.rayTolerance;
+    io.sweptCollision = opt.sweptCollision;
+    io.mode = opt.inference;
+    IslandModel model(io, seed);
+
+    printf("seed %u, %d generations, %d islands x %d agents (%s, %d every %d generations, %s), dt %.4f, %s inference\n",
+           seed, opt.generations, opt.islands, opt.population, opt.fullTopology ? "full" : "ring", opt.migrants,
+           opt.migrateEvery, opt.asyncMigration ? "async" : "sync", opt.dt, inferenceModeName(opt.inference));
+    auto t0 = chrono::steady_clock::now();
+    auto genStart = t0;
+    long long totalSteps = 0;
+    int highScore = 0;
+    float bestFitnessEver = 0.f;
+    model.start();
+
+    // Every island's generation g done -> one line over all islands
+    for (int g = 0; g < opt.generations; ++g) {
+        while (model.completedGenerations() <= g) this_thread::sleep_for(chrono::milliseconds(1));
+        GenStats st; st.generation = g + 1;
+        int score = 0, steps = 0;
+        float avg = 0.f;
+        for (size_t k = 0; k < model.islands.size(); ++k) {
+            const IslandGen& r = model.islands[k]->history[g];
+            st.best = k ? std::max(st.best, r.stats.best) : r.stats.best;
+            st.worst = k ? std::min(st.worst, r.stats.worst) : r.stats.worst;
+            avg += r.stats.avg;
+            score = std::max(score, r.score);
+            steps += r.steps;
+        }
+        st.avg = avg / (float)model.islands.size();
+        highScore = std::max(highScore, score);
+        bestFitnessEver = std::max(bestFitnessEver, st.best);
+        totalSteps += steps;
+
+        auto now = chrono::steady_clock::now();
+        double secs = chrono::duration<double>(now - genStart).count();
+        genStart = now;
+        GenerationRecord rec; // islands fly caves of their own: no single cave seed
+        rec.generation = st.generation;
+        rec.best = st.best; rec.avg = st.avg; rec.worst = st.worst;
+        rec.score = score; rec.highScore = highScore; rec.steps = steps;
+        rec.population = opt.population * opt.islands;
+        rec.seconds = (float)secs;
+        telemetry.generation(rec);
+        if (out) {
+            fprintf(out, "%d,%.3f,%.3f,%.3f,%d,%d,%.6f\n", st.generation, st.best, st.avg, st.worst, score, steps, secs);
+            fflush(out);
+        }
+    }
+    model.join();
+    telemetry.close();
+
+    long long received = 0;
+    for (const auto& isl : model.islands) received += isl->received;
+    double total = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    printf("done: %d generations in %.2fs (%.0f steps/s), best fitness %.1f, high score %d, %lld migrants taken in\n",
+           opt.generations, total, total > 0.0 ? totalSteps / total : 0.0, bestFitnessEver, highScore, received);
+    if (out) fclose(out);
+    return 0;
+}
+
+// == Headless training loop ==
+int runHeadless(const HeadlessOptions& opt) {
+    unsigned seed = opt.seedSet ? opt.seed : std::random_device{}(); // run seed
+    if (opt.es && (opt.islands > 1 || opt.seedChains || !opt.checkpointPath.empty() || !opt.resumePath.empty())) {
+        fprintf(stderr, "--optimizer es: the run state is one centre and its Adam moments; "
+                        "drop --islands/--seed-chains/--farm/--checkpoint/--resume\n");
+        return 1;
+    }
+    if (opt.islands > 1) return runIslands(opt, seed);
+    std::mt19937 rng(seed); // drives weights and selection
+
+    FILE* out = nullptr; // optional stats file
+    if (!opt.outPath.empty()) {
+        out = fopen(opt.outPath.c_str(), "w");
+        if (!out) { fprintf(stderr, "cannot open %s\n", opt.outPath.c_str()); return 1; }
+        fprintf(out, "generation,best,avg,worst,score,steps,seconds\n");
+    }
+
+    // -- Population & agents --
+    vector<Agent> agents; // agent population (--seed-chains: the chunk of it in flight)
+    vector<SeedGenome> genomes, nextGenomes; // --seed-chains: the population as seed chains
+    vector<Agent> tail; // --seed-chains: the population's last, shorter chunk
+    vector<float> chainFitness; // --seed-chains: fitness of genomes[i]
+    const vector<int> topology{NUM_INPUTS, 16, 8, 1}; // the agents' network
+    int   generation = 1; // generation counter
+    int   highScore = 0; // best score so far
+    float bestFitnessEver = 0.f; // best fitness ever
+    if (!opt.resumePath.empty()) { // continue a previous run exactly where it stopped
+        uint64_t runSeed = 0;
+        std::string error;
+        if (!loadCheckpoint(opt.resumePath, agents, generation, highScore, bestFitnessEver, runSeed, rng, error,
+                            opt.seedChains ? &genomes : nullptr)) {
+            fprintf(stderr, "resume failed: %s\n", error.c_str());
+            if (out) fclose(out);
+            return 1;
+        }
+        const int loaded = opt.seedChains ? (int)genomes.size() : (int)agents.size();
+        if (opt.populationSet && opt.population != loaded) {
+            fprintf(stderr, "--resume: %s holds %d agents, drop --population %d\n",
+                    opt.resumePath.c_str(), loaded, opt.population);
+            if (out) fclose(out);
+            return 1;
+        }
+        seed = (unsigned)runSeed;
+        printf("resumed %s: generation %d, %d agents\n", opt.resumePath.c_str(), generation, loaded);
+    } else if (opt.seedChains) { // chains only: weights are rebuilt a chunk at a time when flown
+        genomes.reserve(opt.population);
+        for (int i = 0; i < opt.population; ++i) genomes.emplace_back((uint32_t)rng()); // same seeds as the agents below
+    } else {
+        agents.reserve(opt.population);
+        for (int i = 0; i < opt.population; ++i) { // for each agent
+            agents.emplace_back(NUM_INPUTS, (unsigned)rng()); // seeded agents
+        }
+    }
+    const int population = opt.seedChains ? (int)genomes.size() : (int)agents.size();
+
+    // -- Checkpoints (written on a background thread) --
+    std::unique_ptr<CheckpointWriter> checkpoints;
+    CheckpointState checkpointState; // capture buffer, swapped with the writer's
+    if (!opt.checkpointPath.empty()) checkpoints.reset(new CheckpointWriter(opt.checkpointPath));
+    auto saveCheckpoint = [&] {
+        if (opt.seedChains) captureCheckpoint(genomes, topology, generation, highScore, bestFitnessEver, seed, rng, checkpointState);
+        else captureCheckpoint(agents, generation, highScore, bestFitnessEver, seed, rng, checkpointState);
+        checkpoints->submit(checkpointState);
+    };
+    EvolveBuffers evolveBuffers; // second population buffer, reused every generation
+    Simulation sim; // no window: fixed 800x600 world
+    ThreadPool pool(opt.threads); // persistent workers for the per-agent phases
+    sim.pool = &pool;
+    sim.useField = opt.rayTolerance >= 0.f; // negative -> reference ray marcher
+    sim.field.tolerance = opt.rayTolerance;
+    sim.sweptCollision = opt.sweptCollision;
+    sim.batch.setMode(opt.inference); // int8 weights are requantized on every generation's load
+    FitnessMemo memo; // fitness of genomes already flown, per cave
+    const bool multiCave = opt.caves > 1;
+    const bool farm = !opt.farmPath.empty();
+    // Only repeated caves can hit: with a new cave every generation the memo would
+    // just hash and insert every agent. Multi-cave flights run concurrently, without it.
+    if (opt.memo && opt.caveCycle > 0 && !multiCave && !farm) {
+        sim.memo = &memo;
+        sim.memoParams = sim.flightParams(opt.dt, opt.maxSteps);
+    }
+
+    MultiCaveEvaluator evaluator; // K varied caves per genome with successive halving
+    evaluator.caves = opt.caves;
+    evaluator.firstCaves = std::max(1, opt.caves / 4);
+    evaluator.keep = opt.keep;
+    evaluator.dt = opt.dt;
+    evaluator.maxSteps = opt.maxSteps;
+    evaluator.useField = sim.useField;
+    evaluator.rayTolerance = opt.rayTolerance;
+    evaluator.sweptCollision = opt.sweptCollision;
+    evaluator.mode = opt.inference;
+    evaluator.pool = &pool;
+    long long flights = 0; // multi-cave (genome, cave) flights over the run
+    EvolutionStrategy es; // --optimizer es: the population samples around es.center
+    if (opt.es) {
+        es.sigma = opt.esSigma;
+        es.learningRate = opt.esLearningRate;
+        es.init(agents[0].brain, seed);
+        es.populate(agents, generation, &pool);
+    }
+    // --seed-chains holds only the chains population-wide and flies them a chunk at a
+    // time, rebuilding just that chunk's weights. --caves ranks every genome together
+    // over its rungs, so there the chunk is the whole population; --farm builds none.
+    const int chunk = opt.seedChains && !multiCave && !farm ? std::min(population, CHAIN_CHUNK) : population;
+    GenomeCache genomeCache(topology, 2 * (size_t)std::min(population, CHAIN_CHUNK)); // about two chunks of weights
+    if (opt.seedChains) chainFitness.assign(population, 0.f);
+    FarmCoordinator farmCoordinator; // --farm: worker processes fly the generations
+    if (farm) {
+        std::string error;
+        farmCoordinator.batchSize = opt.farmBatch;
+        if (!farmCoordinator.listen(opt.farmPath, error) || !farmCoordinator.waitForWorkers(opt.farmWorkers, error)) {
+            fprintf(stderr, "farm: %s\n", error.c_str());
+            if (out) fclose(out);
+            return 1;
+        }
+        printf("farm: %d workers on %s\n", farmCoordinator.readyWorkers(), opt.farmPath.c_str());
+    }
+
+    Telemetry telemetry; // echoes the generation lines, optionally writes the columnar file
+    telemetry.recordAgents = opt.telemetryAgents && !opt.telemetryPath.empty();
+    {
+        std::string error;
+        if (!telemetry.open(opt.telemetryPath, error)) {
+            fprintf(stderr, "telemetry: %s\n", error.c_str());
+            if (out) fclose(out);
+            return 1;
+        }
+    }
+
+    printf("seed %u, %d generations, %d agents, dt %.4f, %d threads, %s inference\n",
+           seed, opt.generations, population, opt.dt, pool.size(), inferenceModeName(opt.inference));
+    if (multiCave) printf("%d caves per genome, keeping %.0f%% after each rung\n", opt.caves, 100.0 * opt.keep);
+    if (opt.sweptCollision) printf("swept collision, step scale %d (max %d steps)\n", opt.stepScale, opt.maxSteps);
+    if (opt.es) printf("evolution strategies: %d antithetic pairs, sigma %.3f, Adam lr %.3f\n",
+                       population / 2, opt.esSigma, opt.esLearningRate);
+    auto t0 = chrono::steady_clock::now(); // run start
+    long long totalSteps = 0; // steps over the whole run
+    int targetGeneration = 0; // first generation scoring opt.targetScore (0 = not yet)
+    double targetSeconds = 0.0; // wall clock from the start to that generation's end of flight
+
+    for (int g = 0; g < opt.generations; ++g) {
+        PROFILE_SCOPE("generation");
+        auto genStart = chrono::steady_clock::now();
+        const int caveIndex = opt.caveCycle > 0 ? (generation - 1) % opt.caveCycle : generation; // repeats every caveCycle generations
+        int score = 0, steps = 0; // score of this generation (best flight) and steps simulated
+        const uint32_t genCave = caveSeed(seed, (uint64_t)caveIndex); // first cave's key with --caves
+        for (int begin = 0; begin < population; begin += chunk) { // one pass unless --seed-chains flies chunks
+            const int n = std::min(chunk, population - begin);
+            vector<Agent>& squad = n < chunk ? tail : agents; // both sized once
+            if (opt.seedChains && !farm) { // rebuild just this chunk's weights
+                if ((int)squad.size() != n) squad.resize(n, Agent(NUM_INPUTS, 0u));
+                for (int k = 0; k < n; ++k) squad[k].brain.copyWeightsFrom(genomeCache.get(genomes[begin + k]));
+            }
+            int flightScore = 0, flightSteps = 0; // flights are independent: the generation reports the longest
+            if (farm) {
+                FarmParams fp;
+                fp.caveSeed = genCave;
+                fp.dt = opt.dt;
+                fp.maxSteps = opt.maxSteps;
+                fp.rayTolerance = opt.rayTolerance;
+                fp.inference = (uint32_t)opt.inference;
+                fp.flags = opt.sweptCollision ? FARM_SWEPT_COLLISION : 0;
+                std::string error;
+                if (!farmCoordinator.evaluate(genomes, fp, chainFitness, flightScore, flightSteps, error)) {
+                    fprintf(stderr, "farm: %s\n", error.c_str());
+                    if (out) fclose(out);
+                    return 1;
+                }
+            } else if (multiCave) {
+                evaluator.evaluate(squad, seed, (uint64_t)caveIndex);
+                flightScore = evaluator.bestScore;
+                flightSteps = (int)std::min<long long>(evaluator.steps, INT32_MAX);
+                flights += evaluator.flights;
+            } else {
+                sim.resetGeneration(squad, Cave(genCave)); // seeded cave per generation
+
+                // Fixed timestep, no pacing: run until everyone dies or the step cap hits
+                while (sim.step(squad, opt.dt)) {
+                    if (sim.steps >= opt.maxSteps) { sim.killAll(squad); break; }
+                }
+                flightScore = sim.score;
+                flightSteps = sim.steps;
+            }
+            score = std::max(score, flightScore);
+            steps = std::max(steps, flightSteps);
+            if (opt.seedChains && !farm) {
+                for (int k = 0; k < n; ++k) chainFitness[begin + k] = squad[k].fitness;
+            }
+            if (telemetry.recordAgents) { // components are only known for in-process single-cave flights
+                const bool components = !farm && !multiCave;
+                for (int k = 0; k < n; ++k) {
+                    AgentRecord r;
+                    r.generation = generation;
+                    r.agent = begin + k;
+                    r.caveSeed = genCave;
+                    r.fitness = opt.seedChains ? chainFitness[begin + k] : squad[k].fitness;
+                    r.shaping = components ? sim.runners.fitnessAcc[k] : NAN;
+                    r.survival = components ? sim.runners.deathScroll[k] : NAN;
+                    r.deathScore = components ? sim.runners.deathScore[k] : -1;
+                    r.deathStep = components ? sim.runners.deathStep[k] : -1;
+                    telemetry.agent(r);
+                }
+            }
+        }
+        totalSteps += steps;
+        if (score > highScore) highScore = score;
+        if (opt.targetScore > 0 && !targetGeneration && score >= opt.targetScore) {
+            targetGeneration = generation;
+            targetSeconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        }
+        GenStats st;
+        if (opt.es) {
+            st = es.update(agents, generation, bestFitnessEver, &pool);
+        } else if (opt.seedChains) { // new chains; their weights are rebuilt when flown
+            st = evolveChains(genomes, nextGenomes, chainFitness, evolveBuffers, rng, seed, ELITE_COUNT, MUT_SIGMA, MUT_PROB,
+                              generation, bestFitnessEver);
+        } else {
+            st = evolve(agents, evolveBuffers, rng, seed, ELITE_COUNT, MUT_SIGMA, MUT_PROB,
+                        generation, bestFitnessEver, &pool);
+        }
+
+        double secs = chrono::duration<double>(chrono::steady_clock::now() - genStart).count();
+        GenerationRecord rec;
+        rec.generation = st.generation;
+        rec.caveSeed = genCave;
+        rec.best = st.best; rec.avg = st.avg; rec.worst = st.worst;
+        rec.score = score; rec.highScore = highScore; rec.steps = steps;
+        rec.population = population;
+        rec.seconds = (float)secs;
+        telemetry.generation(rec);
+        if (out) {
+            fprintf(out, "%d,%.3f,%.3f,%.3f,%d,%d,%.6f\n",
+                    st.generation, st.best, st.avg, st.worst, score, steps, secs);
+            fflush(out);
+        }
+        if (checkpoints && (g + 1) % opt.checkpointEvery == 0 && g + 1 < opt.generations) saveCheckpoint();
+    }
+    if (checkpoints) { // final state, then wait for the writer
+        saveCheckpoint();
+        checkpoints->flush();
+        if (!checkpoints->lastError.empty()) fprintf(stderr, "checkpoint: %s\n", checkpoints->lastError.c_str());
+        else printf("checkpoint: %s (%d written)\n", opt.checkpointPath.c_str(), checkpoints->written);
+    }
+
+    telemetry.close(); // every generation line is out before the summary
+    if (!opt.telemetryPath.empty()) {
+        if (!telemetry.error().empty()) fprintf(stderr, "telemetry: %s\n", telemetry.error().c_str());
+        else printf("telemetry: %s, %llu generation rows, %llu agent rows, %llu bytes, %llu stalls\n",
+                    opt.telemetryPath.c_str(), (unsigned long long)telemetry.rows[0],
+                    (unsigned long long)telemetry.rows[1], (unsigned long long)telemetry.bytes,
+                    (unsigned long long)telemetry.stalls);
+    }
+
+    if (!opt.tracePath.empty()) {
+        if (!PROFILING_ENABLED) fprintf(stderr, "--trace: built without -DNRR_PROFILE, no phases recorded\n");
+        else if (!Profiler::instance().dumpChromeTrace(opt.tracePath)) fprintf(stderr, "cannot write %s\n", opt.tracePath.c_str());
+    }
+
+    double total = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    printf("done: %d generations in %.2fs (%.0f steps/s), best fitness %.1f, high score %d\n",
+           opt.generations, total, total > 0.0 ? totalSteps / total : 0.0, bestFitnessEver, highScore);
+    if (opt.targetScore > 0) {
+        if (targetGeneration) printf("target score %d: reached in generation %d after %.2fs\n",
+                                     opt.targetScore, targetGeneration, targetSeconds);
+        else printf("target score %d: not reached\n", opt.targetScore);
+    }
+    if (opt.seedChains) {
+        size_t bytes = 0;
+        for (const SeedGenome& g : genomes) bytes += g.byteSize();
+        const size_t weightBytes = Net(topology, 0u).params.size() * sizeof(float);
+        printf("seed chains: %.0f bytes per genome serialized (weights: %zu), %zu shared links, %d weight sets in flight, "
+               "cache %.1f%% hits, %llu mutations replayed\n",
+               (double)bytes / population, weightBytes, countLinks(genomes), farm ? 0 : chunk,
+               100.0 * genomeCache.hitRate(), (unsigned long long)genomeCache.replayed);
+    }
+    if (farm) {
+        printf("farm: %llu batches, %llu resubmitted, %d workers seen, %llu lost\n",
+               (unsigned long long)farmCoordinator.batchesSent, (unsigned long long)farmCoordinator.resubmitted,
+               farmCoordinator.workersSeen, (unsigned long long)farmCoordinator.workersLost);
+        farmCoordinator.shutdown();
+    }
+    if (multiCave) {
+        printf("multi-cave: %lld flights, %.0f%% of the full %d caves x %d agents\n", flights,
+               100.0 * (double)flights / ((double)opt.caves * population * opt.generations), opt.caves, population);
+    } else if (sim.memo) {
+        printf("fitness memo: %.1f%% hits (%llu of %llu evaluations), %zu entries\n",
+               100.0 * memo.hitRate(), (unsigned long long)memo.hits, (unsigned long long)memo.lookups, memo.entries.size());
+    }
+    if (out) fclose(out);
+    return 0;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <string>
+#include "PopulationNet.hpp"
+
+// Options for the display-less training mode
+struct HeadlessOptions {
+    int generations = 100; // number of generations to train
+    int population = 50; // agents per generation
+    bool populationSet = false; // --population given (must match a resumed checkpoint)
+    unsigned seed = 0; // run seed (agents, evolution and caves)
+    bool seedSet = false; // false -> seed from std::random_device
+    std::string outPath; // per-generation stats CSV (empty -> stdout only)
+    float dt = 1.f / 60.f; // fixed simulation timestep (s)
+    int maxSteps = 36000; // steps before a generation is cut off (10 sim-minutes)
+    int threads = 0; // simulation threads (0 = all cores)
+    InferenceMode inference = InferenceMode::Exact; // network precision (exact, fast tanh, int8)
+    float rayTolerance = 0.05f; // sensing field wall tolerance (px), 0 = exact, <0 = march every ray
+    bool sweptCollision = false; // test the path between steps against the walls, not just the end point
+    int stepScale = 1; // dt multiplier (max steps divided by it, implies sweptCollision)
+    std::string checkpointPath; // population checkpoint written in the background (empty -> none)
+    int checkpointEvery = 10; // generations between checkpoints (a final one is always written)
+    std::string resumePath; // checkpoint to continue training from (empty -> fresh population)
+    int caveCycle = 0; // generations before the caves repeat (0 = a new cave every generation)
+    int caves = 1; // caves per genome and generation (1 = the whole population shares one cave)
+    float keep = 0.5f; // multi-cave: fraction of genomes flying on after each rung (1 = all fly all caves)
+    int islands = 1; // sub-populations evolving on their own threads (1 = a single population)
+    int migrateEvery = 5; // islands: generations between migrations
+    int migrants = 2; // islands: best genomes sent along each edge per migration
+    bool fullTopology = false; // islands: send to every other island instead of the next one
+    bool asyncMigration = false; // islands: take whatever has arrived instead of waiting (not reproducible)
+    bool seedChains = false; // keep genomes as seed chains, rebuilding weights per flight chunk
+    std::string farmPath; // evaluate on farm workers connecting to this Unix socket (empty -> in process)
+    int farmWorkers = 1; // farm: workers to wait for before the first generation
+    int farmBatch = 32; // farm: genomes per batch
+    bool es = false; // evolution strategies (antithetic noise around one centre) instead of the GA
+    float esSigma = 0.1f; // es: perturbation scale
+    float esLearningRate = 0.03f; // es: Adam step size
+    int targetScore = 0; // report when a generation's score first reaches this (0 = off)
+    bool memo = true; // reuse the fitness of genomes already flown on the same cave
+    std::string telemetryPath; // columnar telemetry file written in the background (empty -> none)
+    bool telemetryAgents = false; // telemetry: one row per agent and generation as well
+    std::string tracePath; // Chrome trace of the last phase timings (needs -DNRR_PROFILE)
+};
+
+// Returns true if the command line asks for headless mode
+bool wantsHeadless(int argc, char** argv);
+
+// Parse headless options, returns false (after printing usage) on bad input
+bool parseHeadlessArgs(int argc, char** argv, HeadlessOptions& opt);
+
+// Train as fast as the CPU allows without creating a window, renderer or font
+int runHeadless(const HeadlessOptions& opt);
@@ -0,0 +1,117 @@
+#include "Islands.hpp"
+#include <algorithm>
+
+using namespace std;
+
+IslandModel::IslandModel(const IslandOptions& options, uint64_t runSeed) : opt(options) {
+    const int m = std::max(1, opt.islands);
+    for (int k = 0; k < m; ++k) {
+        unique_ptr<Island> isl(new Island());
+        isl->index = k;
+        isl->seed = streamKey(runSeed, 0x15A4Dull, (uint64_t)k); // independent per island
+        isl->rng.seed((unsigned)isl->seed);
+        isl->agents.reserve(opt.population);
+        for (int i = 0; i < opt.population; ++i) isl->agents.emplace_back(NUM_INPUTS, (unsigned)isl->rng());
+        isl->sim.useField = opt.useField;
+        isl->sim.field.tolerance = opt.rayTolerance;
+        isl->sim.sweptCollision = opt.sweptCollision;
+        isl->sim.batch.setMode(opt.mode);
+        isl->history.resize(std::max(0, opt.generations));
+        islands.push_back(std::move(isl));
+    }
+
+    // Edges: every in-flight batch fits, so a synchronous sender never waits for long
+    const size_t capacity = (size_t)(m + 1) * std::max(1, opt.migrants);
+    auto connect = [&](int from, int to) {
+        queues.emplace_back(new MigrationQueue(capacity, islands[from]->agents[0]));
+        islands[from]->outbound.push_back(queues.back().get());
+        islands[to]->inbound.push_back(queues.back().get());
+    };
+    if (m > 1 && opt.migrants > 0) {
+        for (int k = 0; k < m; ++k) {
+            if (opt.topology == MigrationTopology::Ring) connect(k, (k + 1) % m);
+            else for (int j = 0; j < m; ++j) if (j != k) connect(k, j);
+        }
+    }
+}
+
+void IslandModel::start() {
+    for (auto& isl : islands) {
+        Island* p = isl.get();
+        threads.emplace_back([this, p] { runIsland(*p); });
+    }
+}
+
+void IslandModel::join() {
+    for (thread& t : threads) if (t.joinable()) t.join();
+    threads.clear();
+}
+
+int IslandModel::completedGenerations() const {
+    int done = opt.generations;
+    for (const auto& isl : islands) done = std::min(done, isl->completed.load(memory_order_acquire));
+    return done;
+}
+
+// -- Send copies of the best genomes (fitness of the generation just flown) along every outbound edge --
+void IslandModel::emigrate(Island& isl) {
+    const int n = (int)isl.agents.size();
+    const int k = std::min(opt.migrants, n);
+    vector<int>& order = isl.order;
+    order.resize(n);
+    for (int i = 0; i < n; ++i) order[i] = i;
+    std::partial_sort(order.begin(), order.begin() + k, order.end(), [&](int a, int b) {
+        if (isl.agents[a].fitness != isl.agents[b].fitness) return isl.agents[a].fitness > isl.agents[b].fitness;
+        return a < b;
+    });
+    for (MigrationQueue* q : isl.outbound) {
+        for (int i = 0; i < k; ++i) {
+            while (!q->push(isl.agents[order[i]])) {
+                if (!opt.syncMigration) break; // async: a full edge drops the migrant
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+// -- Replace the last children of the new population with arrivals (elites are never replaced) --
+void IslandModel::immigrate(Island& isl) {
+    const int n = (int)isl.agents.size();
+    int slot = n - 1;
+    const int lowest = std::min(n, ELITE_COUNT); // first non-elite slot
+    for (MigrationQueue* q : isl.inbound) {
+        const int want = std::min(opt.migrants, n); // one batch per edge and migration
+        for (int i = 0; i < want || !opt.syncMigration; ++i) {
+            Agent& into = slot >= lowest ? isl.agents[slot] : isl.evolveBuffers.next[0]; // surplus is popped and discarded
+            if (opt.syncMigration) {
+                while (!q->pop(into)) std::this_thread::yield(); // sender is at most a few generations behind
+            } else if (!q->pop(into)) {
+                break; // nothing more has arrived
+            }
+            into.fitness = 0.f;
+            if (slot >= lowest) { --slot; ++isl.received; }
+        }
+    }
+}
+
+void IslandModel::runIsland(Island& isl) {
+    for (int g = 0; g < opt.generations; ++g) {
+        PROFILE_SCOPE("island/generation");
+        isl.sim.resetGeneration(isl.agents, Cave(caveSeed(isl.seed, (uint64_t)isl.generation)));
+        while (isl.sim.step(isl.agents, opt.dt)) {
+            if (isl.sim.steps >= opt.maxSteps) { isl.sim.killAll(isl.agents); break; }
+        }
+        IslandGen& rec = isl.history[g];
+        rec.score = isl.sim.score;
+        rec.steps = isl.sim.steps;
+        if (rec.score > isl.highScore) isl.highScore = rec.score;
+
+        const bool migrate = isl.inbound.size() + isl.outbound.size() > 0
+                          && (g + 1) % opt.migrateEvery == 0 && g + 1 < opt.generations;
+        if (migrate) emigrate(isl);
+        rec.stats = evolve(isl.agents, isl.evolveBuffers, isl.rng, isl.seed, ELITE_COUNT, MUT_SIGMA, MUT_PROB,
+                           isl.generation, isl.bestFitnessEver);
+        if (migrate) immigrate(isl);
+        isl.completed.store(g + 1, memory_order_release);
+    }
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Sim.hpp"
+
+using std::vector;
+
+// == Island model ==
+// M sub-populations evolve side by side, each on its own thread with its own
+// RNG, mutation streams and caves (all keyed by the island seed). Every few
+// generations each island sends copies of its best genomes to its neighbours
+// (ring: the next island, full: every other island); arrivals replace the
+// island's last children, never its elites.
+//
+// Each directed edge is a single-producer / single-consumer ring, so sending
+// and receiving never take a lock. With synchronous migration an island waits
+// (yielding) for its neighbours' batch of the same generation, which makes a
+// run reproducible; asynchronous migration takes whatever has arrived.
+
+// -- Lock-free SPSC queue of genomes (preallocated, copies reuse the slots' buffers) --
+struct MigrationQueue {
+    vector<Agent> slots; // capacity is a power of two
+    size_t mask = 0;
+    alignas(64) std::atomic<uint64_t> head{0}; // next slot to read (consumer only writes)
+    alignas(64) std::atomic<uint64_t> tail{0}; // next slot to write (producer only writes)
+
+    MigrationQueue(size_t capacity, const Agent& shape) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        slots.assign(cap, shape);
+        mask = cap - 1;
+    }
+
+    bool push(const Agent& a) {
+        const uint64_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) > mask) return false; // full
+        Agent& s = slots[t & mask];
+        s.brain.copyWeightsFrom(a.brain);
+        s.fitness = a.fitness;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(Agent& into) {
+        const uint64_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false; // empty
+        const Agent& s = slots[h & mask];
+        into.brain.copyWeightsFrom(s.brain);
+        into.fitness = s.fitness;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+enum class MigrationTopology { Ring, Full };
+
+struct IslandOptions {
+    int islands = 4; // sub-populations (one thread each)
+    int population = 50; // agents per island
+    int generations = 100; // generations per island
+    int migrateEvery = 5; // generations between migrations
+    int migrants = 2; // best genomes sent along each edge per migration
+    MigrationTopology topology = MigrationTopology::Ring;
+    bool syncMigration = true; // wait for the neighbours' batch (reproducible) or take what has arrived
+    float dt = 1.f / 60.f; // fixed timestep
+    int maxSteps = 36000; // steps before a generation is cut off
+    bool useField = true; // shared sensing field (false = march every ray)
+    float rayTolerance = 0.05f; // sensing field wall tolerance
+    bool sweptCollision = false; // swept wall test between steps (see Simulation)
+    InferenceMode mode = InferenceMode::Exact; // network precision
+};
+
+// Per-generation record of one island (written by the island, read after its counter moved)
+struct IslandGen {
+    GenStats stats; // fitness statistics before evolving
+    int score = 0; // generation score
+    int steps = 0; // steps simulated
+};
+
+struct Island {
+    int index = 0;
+    uint64_t seed = 0; // keys this island's caves, mutations and RNG
+    std::mt19937 rng; // initial weights and selection
+    vector<Agent> agents; // sub-population
+    EvolveBuffers evolveBuffers;
+    Simulation sim; // single-threaded
+    int generation = 1; // generation counter
+    int highScore = 0;
+    float bestFitnessEver = 0.f;
+    vector<MigrationQueue*> inbound, outbound; // edges (owned by the model)
+    vector<IslandGen> history; // one entry per generation
+    std::atomic<int> completed{0}; // generations recorded in history
+    long long received = 0; // immigrants taken in
+    vector<int> order; // scratch: best-first indices
+};
+
+struct IslandModel {
+    IslandOptions opt;
+    vector<std::unique_ptr<Island>> islands;
+    vector<std::unique_ptr<MigrationQueue>> queues; // one per directed edge
+    vector<std::thread> threads;
+
+    IslandModel(const IslandOptions& options, uint64_t runSeed);
+    ~IslandModel() { join(); }
+
+    void start(); // one thread per island
+    void join();
+
+    // Generations every island has finished (history entries below this are safe to read)
+    int completedGenerations() const;
+
+private:
+    void runIsland(Island& isl);
+    void emigrate(Island& isl);
+    void immigrate(Island& isl);
+};
@@ -0,0 +1,135 @@
+#include "MultiCaveEval.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace std;
+
+Cave variedCave(unsigned seed) {
+    mt19937 rng(seed);
+    uniform_real_distribution<float> gap(150.f, 210.f); // around the default 180
+    uniform_real_distribution<float> amp(90.f, 150.f); // around the default 120
+    uniform_real_distribution<float> freq(-0.0005f, 0.0005f); // same range as Cave(seed)
+    const float g = gap(rng), a = amp(rng), f = freq(rng); // fixed draw order
+    return Cave(g, a, f, seed); // start phase from the seed
+}
+
+// -- Fly survivors on caves [caveBegin, caveEnd), filling flightFitness --
+void MultiCaveEvaluator::fly(const vector<Agent>& agents, int caveBegin, int caveEnd) {
+    const int m = (int)survivors.size();
+    const int caveCount = caveEnd - caveBegin;
+    const int workers = pool ? pool->size() : 1;
+
+    // Enough tasks to keep every worker busy, none smaller than one SIMD block
+    const int minChunk = PopulationNet::LANES;
+    int chunks = std::max(1, (2 * workers + caveCount - 1) / caveCount);
+    chunks = std::min(chunks, std::max(1, m / minChunk));
+    const int chunkSize = (m + chunks - 1) / chunks;
+    tasks.clear();
+    for (int c = caveBegin; c < caveEnd; ++c) {
+        for (int b = 0; b < m; b += chunkSize) tasks.push_back(Task{c, b, std::min(m, b + chunkSize)});
+    }
+    taskScore.assign(tasks.size(), 0);
+    taskSteps.assign(tasks.size(), 0);
+
+    if ((int)sims.size() < workers) {
+        sims.resize(workers);
+        squads.resize(workers);
+    }
+    for (Simulation& s : sims) { // flight settings (no nested pool, no memo)
+        s.pool = nullptr;
+        s.useField = useField;
+        s.field.tolerance = rayTolerance;
+        s.sweptCollision = sweptCollision;
+        s.batch.setMode(mode);
+    }
+
+    auto run = [&](int begin, int end, int worker) {
+        Simulation& sim = sims[worker];
+        vector<Agent>& squad = squads[worker];
+        for (int t = begin; t < end; ++t) {
+            const Task& task = tasks[t];
+            squad.clear();
+            for (int k = task.begin; k < task.end; ++k) squad.push_back(agents[survivors[k]]);
+            sim.resetGeneration(squad, caveSet[task.cave]);
+            while (sim.step(squad, dt)) {
+                if (sim.steps >= maxSteps) { sim.killAll(squad); break; }
+            }
+            for (int k = task.begin; k < task.end; ++k) {
+                flightFitness[(size_t)survivors[k] * caves + task.cave] = squad[k - task.begin].fitness;
+            }
+            taskScore[t] = sim.score;
+            taskSteps[t] = sim.steps;
+        }
+    };
+    if (pool) pool->parallelFor((int)tasks.size(), 1, run);
+    else run(0, (int)tasks.size(), 0);
+
+    // Serial reduction: a cave's flight lasts as long as its longest task (same for any split)
+    caveSteps.assign(caveCount, 0);
+    for (size_t t = 0; t < tasks.size(); ++t) {
+        bestScore = std::max(bestScore, taskScore[t]);
+        int& cs = caveSteps[tasks[t].cave - caveBegin];
+        cs = std::max(cs, taskSteps[t]);
+    }
+    for (int s : caveSteps) steps += s;
+    flights += (long long)m * caveCount;
+}
+
+void MultiCaveEvaluator::evaluate(vector<Agent>& agents, uint64_t runSeed, uint64_t caveIndex) {
+    PROFILE_SCOPE("multicave");
+    const int n = (int)agents.size();
+    caves = std::max(1, caves);
+    caveSet.clear();
+    const uint64_t setKey = caveSeed(runSeed, caveIndex); // same cave set whenever caveIndex repeats
+    for (int k = 0; k < caves; ++k) caveSet.push_back(variedCave((unsigned)streamKey(setKey, (uint64_t)k)));
+
+    flightFitness.assign((size_t)n * caves, 0.f);
+    mean.assign(n, 0.f);
+    survivors.resize(n);
+    for (int i = 0; i < n; ++i) survivors[i] = i;
+    culled.clear();
+    rungSizes.clear();
+    bestScore = 0; steps = 0; flights = 0;
+
+    int done = 0; // caves flown by every survivor
+    int next = std::min(caves, std::max(1, firstCaves));
+    for (;;) {
+        rungSizes.push_back((int)survivors.size());
+        fly(agents, done, next);
+        for (int i : survivors) { // mean over the caves flown so far (fixed order)
+            float sum = 0.f;
+            for (int c = 0; c < next; ++c) sum += flightFitness[(size_t)i * caves + c];
+            mean[i] = sum / (float)next;
+        }
+        if (next == caves) break;
+
+        // Successive halving: keep the best fraction (index order on ties)
+        const int m = (int)survivors.size();
+        const int keepCount = std::min(m, std::max(std::min(n, minSurvivors), (int)std::ceil(m * keep)));
+        std::sort(survivors.begin(), survivors.end(), [&](int a, int b) {
+            if (mean[a] != mean[b]) return mean[a] > mean[b];
+            return a < b;
+        });
+        culled.emplace_back(survivors.begin() + keepCount, survivors.end());
+        survivors.resize(keepCount);
+        std::sort(survivors.begin(), survivors.end()); // flights stay in agent order
+        done = next;
+        next = std::min(caves, next * 2);
+    }
+
+    // Final fitness: survivors' full mean, culled genomes capped below those that went on
+    float ceiling = 1e30f;
+    for (int i : survivors) {
+        agents[i].fitness = mean[i];
+        ceiling = std::min(ceiling, mean[i]);
+    }
+    for (int r = (int)culled.size() - 1; r >= 0; --r) {
+        float lowest = ceiling;
+        for (int i : culled[r]) {
+            agents[i].fitness = std::min(mean[i], std::nextafter(ceiling, -1e30f)); // strictly below
+            lowest = std::min(lowest, agents[i].fitness);
+        }
+        ceiling = lowest;
+    }
+}
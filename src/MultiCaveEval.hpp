@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Sim.hpp"
+#include "ThreadPool.hpp"
+
+using std::vector;
+
+// == Multi-cave fitness with successive halving ==
+// Every genome is scored by its mean fitness over up to K caves that differ in
+// layout and shape (gap, wall amplitude, path frequency), instead of a single
+// cave shared by the whole population. Caves are spent in rungs: all genomes
+// fly the first caves, then only the best `keep` fraction flies the next rung
+// (twice as many caves so far), and so on until the survivors have flown all
+// K. A genome culled at a rung keeps its mean so far, capped at the lowest
+// fitness of the genomes that went on, so it never outranks them.
+//
+// Flights are independent, so each rung is cut into (cave, genome range)
+// tasks for the pool, and results do not depend on the thread count.
+
+// Cave with shape parameters drawn from its seed (a harder or easier variant of the default)
+Cave variedCave(unsigned seed);
+
+struct MultiCaveEvaluator {
+    // -- Schedule --
+    int caves = 8; // K: caves flown by the final survivors
+    int firstCaves = 2; // caves flown by every genome (doubles each rung)
+    float keep = 0.5f; // fraction of the genomes going on after each rung (1 = no culling)
+    int minSurvivors = 2 * ELITE_COUNT; // never cull below this many genomes
+
+    // -- Flight parameters (copied into every worker's Simulation) --
+    float dt = 1.f / 60.f; // fixed timestep
+    int maxSteps = 36000; // steps before a flight is cut off
+    bool useField = true; // shared sensing field (false = march every ray)
+    float rayTolerance = 0.05f; // sensing field wall tolerance
+    bool sweptCollision = false; // swept wall test between steps (see Simulation)
+    InferenceMode mode = InferenceMode::Exact; // network precision
+    ThreadPool* pool = nullptr; // optional workers, one flight task each (not owned)
+
+    // -- Results of the last evaluate --
+    int bestScore = 0; // best score over all flights
+    long long steps = 0; // steps simulated, summed over the caves of each rung
+    long long flights = 0; // (genome, cave) pairs flown
+    vector<int> rungSizes; // genomes flying each rung
+
+    // -- Score every agent (sets Agent::fitness); caveIndex picks the cave set like Cave seeds do --
+    void evaluate(vector<Agent>& agents, uint64_t runSeed, uint64_t caveIndex);
+
+private:
+    struct Task { int cave, begin, end; }; // survivors[begin, end) on caveSet[cave]
+    vector<Cave> caveSet; // this evaluation's caves
+    vector<float> flightFitness; // [agent * caves + cave]
+    vector<float> mean; // mean fitness over the caves flown so far
+    vector<int> survivors; // genomes still flying
+    vector<vector<int>> culled; // genomes dropped after each rung
+    vector<Task> tasks;
+    vector<int> taskScore; vector<int> taskSteps; // per task, reduced serially
+    vector<int> caveSteps; // longest task per cave of a rung
+    vector<Simulation> sims; // one per worker
+    vector<vector<Agent>> squads; // the genomes of one task, per worker
+
+    void fly(const vector<Agent>& agents, int caveBegin, int caveEnd);
+};
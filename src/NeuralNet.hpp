@@ -3,47 +3,91 @@
 #include <random>
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <new>
+#include "Rng.hpp"
 
 using std::vector;
 using std::mt19937;
 using std::uniform_real_distribution;
-using std::normal_distribution;
 
-// == Nueron ==
-struct Neuron { // Single neuron
-    vector<float> weights; // Flattened weight matrix
+// == Aligned allocator (keeps parameter buffers SIMD/cache-line aligned) ==
+template <class T, size_t Align = 64>
+struct AlignedAllocator {
+    using value_type = T;
+    template <class U> struct rebind { using other = AlignedAllocator<U, Align>; };
 
-    static inline float act(float x) {
-        return tanh(x); // Activation function (tanh)
-    }
+    AlignedAllocator() = default;
+    template <class U> AlignedAllocator(const AlignedAllocator<U, Align>&) {}
 
-    float forward (const vector<float>& inputs) const {
-        float s = weights.back(); // Bias term
-        const int n = (int)inputs.size();
-        for (int i = 0; i < n; i++) {
-            s += weights[i] * inputs[i]; // Weighted sum
-        }
-        return act(s); // Apply activation function
+    T* allocate(size_t n) {
+        size_t bytes = (n * sizeof(T) + Align - 1) / Align * Align; // round up to alignment
+        void* p = ::operator new(bytes, std::align_val_t(Align));
+        return static_cast<T*>(p);
     }
+    void deallocate(T* p, size_t) { ::operator delete(p, std::align_val_t(Align)); }
+
+    template <class U> bool operator==(const AlignedAllocator<U, Align>&) const { return true; }
+    template <class U> bool operator!=(const AlignedAllocator<U, Align>&) const { return false; }
 };
+using AlignedFloats = vector<float, AlignedAllocator<float>>;
 
-// == Layer of neurons ==
-struct Layer {
-    vector<Neuron> neurons; // Neurons in this layer
+static constexpr size_t NET_ALIGN_FLOATS = 16; // layer blocks start on 64-byte boundaries
 
-    vector<float> forward(const vector<float>& inputs) const {
-        vector<float> outputs; // Output activations
-        outputs.reserve(neurons.size());
-        for (const Neuron& neuron: neurons) {
-            outputs.push_back(neuron.forward(inputs)); // Forward pass for each neuron
-        }
-        return outputs;
+// == Mutation draws shared by every network type ==
+// Indices in [0, count) of the parameters hit by mutation `key`, ascending.
+// Gaps between hits are Geometric(prob), so the cost is proportional to the
+// number of hits rather than the number of parameters.
+inline void mutationIndices(uint64_t key, float prob, size_t count, vector<size_t>& out) {
+    out.clear();
+    if (prob <= 0.f) return;
+    CounterRng skip(key); // gap stream
+    const float logKeep = prob < 1.f ? std::log1p(-prob) : 0.f; // log(1 - prob)
+    size_t idx = (size_t)-1; // index over real parameters
+    for (;;) {
+        float skipped = prob >= 1.f ? 0.f : std::log(skip.uniformOpen()) / logKeep;
+        if (skipped >= (float)count) break; // past the end
+        idx += 1 + (size_t)skipped;
+        if (idx >= count) break;
+        out.push_back(idx);
     }
+}
+
+// N(0, 1) noise for the hits of mutation `key` (a stream separate from the gaps)
+inline void mutationNoise(uint64_t key, float* out, int n) {
+    gaussianFill(key ^ 0x6A09E667F3BCC908ull, out, n);
+}
+
+// == Layer of neurons (view into the network's parameter buffer) ==
+struct Layer {
+    int inSize = 0; // number of inputs
+    int outSize = 0; // number of neurons
+    size_t offset = 0; // start of this layer's block in Net::params
+    // Block layout: row-major weights [out][in] followed by biases [out]
+    size_t weightOffset() const { return offset; }
+    size_t biasOffset() const { return offset + (size_t)outSize * inSize; }
+    size_t blockSize() const { return (size_t)outSize * (inSize + 1); }
 };
 
 // == Neural Network ==
 struct Net {
     vector<Layer> layers; // Layers in the network
+    AlignedFloats params; // All weights and biases, one aligned block per layer
+    int maxWidth = 0; // Widest layer (input included), sizes the scratch buffer
+
+    static inline float act(float x) {
+        return tanh(x); // Activation function (tanh)
+    }
+
+    // -- Fast tanh: [7/6] rational (Lambert continued fraction), |error| < 1e-4 everywhere --
+    // Branch-free (clamps instead of tests), so loops over it vectorize.
+    static inline float actFast(float x) {
+        x = std::min(4.92f, std::max(-4.92f, x)); // beyond this tanh rounds to +-1 within the bound
+        const float x2 = x * x;
+        const float p = x * (135135.f + x2 * (17325.f + x2 * (378.f + x2)));
+        const float q = 135135.f + x2 * (62370.f + x2 * (3150.f + 28.f * x2));
+        return std::min(1.f, std::max(-1.f, p / q));
+    }
 
     explicit Net(const vector<int>& layerSizes, unsigned seed = std::random_device{}()) {
         mt19937 rng(seed); // Random number generator
@@ -51,32 +95,72 @@ struct Net {
 
         layers.resize(layerSizes.size() - 1); // Number of layers excluding input layer
 
+        size_t total = 0; // Running parameter count (with alignment padding)
         for (size_t l = 0; l < layerSizes.size() - 1; l++) {
-            const int inSize = layerSizes[l]; // Number of inputs to this layer
-            const int outSize = layerSizes[l + 1]; // Number of neurons in this layer
-            Layer L; // Current layer
-            L.neurons.resize(outSize); // Resize neurons
-
-            for (int n = 0; n < outSize; n++) { // For each neuron
-                auto& neuron = L.neurons[n].weights; // Current neuron
-                neuron.resize(inSize + 1); // +1 for bias
-                for (int k = 0; k < inSize + 1; k++) { // For each weight
-                    neuron[k] = dist(rng); // Initialize weights randomly
+            Layer& L = layers[l];
+            L.inSize = layerSizes[l]; // Number of inputs to this layer
+            L.outSize = layerSizes[l + 1]; // Number of neurons in this layer
+            L.offset = total;
+            total += (L.blockSize() + NET_ALIGN_FLOATS - 1) / NET_ALIGN_FLOATS * NET_ALIGN_FLOATS;
+            maxWidth = std::max(maxWidth, std::max(L.inSize, L.outSize));
+        }
+        params.assign(total, 0.f); // Padding stays zero
+
+        for (const Layer& L : layers) {
+            float* w = params.data() + L.weightOffset();
+            float* b = params.data() + L.biasOffset();
+            for (int n = 0; n < L.outSize; n++) { // For each neuron (weights, then bias)
+                for (int k = 0; k < L.inSize; k++) {
+                    w[(size_t)n * L.inSize + k] = dist(rng); // Initialize weights randomly
                 }
+                b[n] = dist(rng); // Initialize bias randomly
             }
-            layers[l] = L; // Assign layer
         }
     }
 
-    // -- Forward pass through the network --
-    float forward(vector<float> x) const { // Input vector
-        for (const Layer& layer : layers) { // For each layer
-            x = layer.forward(x); // Forward pass through each layer
+    bool sameTopology(const Net& other) const {
+        if (layers.size() != other.layers.size()) return false;
+        for (size_t l = 0; l < layers.size(); l++) {
+            if (layers[l].inSize != other.layers[l].inSize || layers[l].outSize != other.layers[l].outSize) return false;
         }
-        if (x.empty()) { 
+        return true;
+    }
+
+    int inputSize() const { return layers.empty() ? 0 : layers.front().inSize; }
+    int outputSize() const { return layers.empty() ? 0 : layers.back().outSize; }
+    size_t scratchSize() const { return 2 * (size_t)maxWidth; } // Floats needed by forward()
+
+    // -- Forward pass through the network (no allocation) --
+    // x holds inputSize() floats, scratch holds scratchSize() floats
+    float forward(const float* x, float* scratch) const {
+        const float* in = x; // Current layer input
+        float* bufs[2] = {scratch, scratch + maxWidth}; // Ping-pong activations
+        int cur = 0;
+        for (const Layer& L : layers) { // For each layer
+            const float* w = params.data() + L.weightOffset();
+            const float* b = params.data() + L.biasOffset();
+            float* out = bufs[cur];
+            for (int n = 0; n < L.outSize; n++) { // For each neuron
+                const float* row = w + (size_t)n * L.inSize;
+                float s = b[n]; // Bias term
+                for (int i = 0; i < L.inSize; i++) {
+                    s += row[i] * in[i]; // Weighted sum
+                }
+                out[n] = act(s); // Apply activation function
+            }
+            in = out; cur ^= 1;
+        }
+        if (layers.empty() || outputSize() == 0) {
             return 0.f; // No output
         }
-        return x[0]; // Return first output
+        return in[0]; // Return first output
+    }
+
+    // -- Convenience forward pass (per-thread scratch, allocates only on growth) --
+    float forward(const vector<float>& x) const {
+        thread_local vector<float> scratch;
+        if (scratch.size() < scratchSize()) scratch.resize(scratchSize());
+        return forward(x.data(), scratch.data());
     }
 
     // -- Decision based on output --
@@ -85,35 +169,36 @@ struct Net {
     }
 
     // -- Mutation for evolutionary strategies --
-    void mutate(std::mt19937& rng, float sigma, float prob) {
-        normal_distribution<float> dist(0.f, sigma); // Gaussian distribution for mutation
-        uniform_real_distribution<float> probDist(0.0f, 1.0f); // Uniform distribution for mutation probability
-        
-        for (size_t l = 0; l < layers.size(); l++) { // For each layer
-            Layer& L = layers[l];
-            for (size_t n = 0; n < L.neurons.size(); n++) { // For each neuron
-                Neuron& neuron = L.neurons[n];
-                for (size_t k = 0; k < neuron.weights.size(); k++) { // For each weight
-                    if (probDist(rng) < prob) { // Mutate with given probability
-                        neuron.weights[k] += dist(rng); // Add Gaussian noise
-                    }
-                }
-            }
+    // Each weight or bias is perturbed with probability prob by N(0, sigma^2)
+    // noise. Everything is drawn from the counter stream `key` (see
+    // mutationKey), so the same key always gives the same offspring on any
+    // thread. Geometric skipping jumps straight from one mutated parameter to
+    // the next, and the Gaussian noise for all of them is generated as a batch.
+    void mutate(uint64_t key, float sigma, float prob) {
+        if (prob <= 0.f || sigma == 0.f) return;
+        thread_local vector<size_t> hits; // real-parameter indices hit by this mutation
+        thread_local vector<float> noise; // their Gaussian perturbations
+
+        size_t count = 0; // real parameters (padding excluded)
+        for (const Layer& L : layers) count += L.blockSize();
+        mutationIndices(key, prob, count, hits);
+        noise.resize(hits.size());
+        mutationNoise(key, noise.data(), (int)noise.size());
+
+        size_t li = 0, layerStart = 0; // layer cursor and its first parameter index
+        for (size_t k = 0; k < hits.size(); ++k) { // hits are ascending
+            while (hits[k] >= layerStart + layers[li].blockSize()) { layerStart += layers[li].blockSize(); ++li; }
+            params[layers[li].offset + (hits[k] - layerStart)] += sigma * noise[k]; // Add Gaussian noise
         }
     }
 
     // -- Copy weights from another network --
     void copyWeightsFrom(const Net& other) {
-        layers.resize(other.layers.size()); // Resize layers
-        for (size_t l = 0; l < other.layers.size(); l++) { // For each layer
-            const Layer& otherLayer = other.layers[l];
-            Layer& layer = layers[l];
-            layer.neurons.resize(otherLayer.neurons.size()); // Resize neurons
-            for (size_t n = 0; n < otherLayer.neurons.size(); n++) { // For each neuron
-                const Neuron& otherNeuron = otherLayer.neurons[n]; // Get neuron from other network
-                Neuron& neuron = layer.neurons[n]; // Current neuron
-                neuron.weights = otherNeuron.weights; // Copy weights
-            }
+        if (!sameTopology(other)) { // Topology differs: take it over
+            layers = other.layers;
+            maxWidth = other.maxWidth;
+            params.resize(other.params.size());
         }
+        std::copy(other.params.begin(), other.params.end(), params.begin()); // One linear copy
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,458 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include "NeuralNet.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define NRR_X86_SIMD 1
+#endif
+
+// GCC 12's avx512fintrin.h trips -Wmaybe-uninitialized on its own
+// _mm512_undefined_* placeholders when inlined into target() functions
+#if defined(NRR_X86_SIMD) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#define NRR_POP_DIAGNOSTICS 1
+#endif
+
+using std::vector;
+
+// == Inference precision ==
+// Exact    fp32 weights, std::tanh, same op order within a kernel; the kernel is
+//          picked per CPU (AVX-512 / AVX2 with FMA / scalar), so results may
+//          differ by ISA and from the unfused sums of Net::forward
+// FastTanh fp32 weights, rational tanh (Net::actFast, |error| < 1e-4 per neuron)
+// Int8     int8 weights (per-neuron scale), int16 activations, int32 accumulation,
+//          fast tanh; weights are quantized when genomes are loaded (after evolve)
+enum class InferenceMode { Exact, FastTanh, Int8 };
+
+inline const char* inferenceModeName(InferenceMode m) {
+    return m == InferenceMode::Exact ? "exact" : m == InferenceMode::FastTanh ? "fast" : "int8";
+}
+
+// == Batched inference for a population sharing one topology ==
+// Agents are grouped in blocks of LANES; inside a block every parameter is
+// stored lane-interleaved, so one SIMD register holds the same weight of
+// LANES different agents:
+//   weights: [block][layer][out][in][lane], biases: [block][layer][out][lane]
+//   inputs:  [block][in][lane]
+// A whole step is then one dense kernel per layer and block, and blocks whose
+// agents are all dead are skipped.
+struct PopulationNet {
+    static constexpr int LANES = 16; // agents per block (one AVX-512 / two AVX2 registers)
+
+    struct LayerDims {
+        int inSize = 0, outSize = 0; // layer shape
+        size_t offset = 0; // start of this layer inside a block's parameters
+        int pairs = 0; // (inSize + 1) / 2, quantized inputs are processed in pairs
+        size_t qOffset = 0; // start of this layer inside a block's int8 weights
+        size_t sOffset = 0; // start of this layer inside a block's row scales
+    };
+
+    // Fixed-point scales of the quantized activations: network inputs are
+    // normalized to about [-1, 1] but may overshoot (|x| < 8), hidden layers
+    // are tanh outputs in [-1, 1]
+    static constexpr float Q_INPUT_SCALE = 4096.f;
+    static constexpr float Q_HIDDEN_SCALE = 32767.f;
+    using AlignedInt8 = vector<int8_t, AlignedAllocator<int8_t>>;
+
+    vector<LayerDims> layers; // shared topology
+    int numAgents = 0; // population size
+    int numBlocks = 0; // ceil(numAgents / LANES)
+    int activeRows = 0; // rows [0, activeRows) are evaluated (see moveRow)
+    int maxWidth = 0; // widest layer
+    size_t blockParams = 0; // floats per block (all layers)
+    AlignedFloats params; // lane-interleaved weights and biases
+    AlignedFloats inputs; // lane-interleaved network inputs
+    AlignedFloats scratch; // two activation buffers for one block
+    vector<float> outputs; // first network output per agent
+
+    InferenceMode mode = InferenceMode::Exact; // precision of forward()
+    AlignedInt8 qweights; // Int8: [block][layer][out][pair][lane][2]
+    AlignedFloats qscales; // Int8: [block][layer][out][lane] dequantization factors
+    size_t qBlockWeights = 0, qBlockScales = 0; // per block sizes of the above
+
+    // -- Copy the genomes of a population into the batch layout --
+    void load(const vector<const Net*>& nets) {
+        numAgents = (int)nets.size();
+        numBlocks = (numAgents + LANES - 1) / LANES;
+        activeRows = numAgents;
+        if (numAgents == 0) return;
+
+        const Net& ref = *nets[0]; // every net shares this topology
+        layers.resize(ref.layers.size());
+        blockParams = 0; maxWidth = 0;
+        for (size_t l = 0; l < ref.layers.size(); l++) {
+            layers[l].inSize = ref.layers[l].inSize;
+            layers[l].outSize = ref.layers[l].outSize;
+            layers[l].offset = blockParams;
+            blockParams += (size_t)layers[l].outSize * (layers[l].inSize + 1) * LANES;
+            maxWidth = std::max(maxWidth, std::max(layers[l].inSize, layers[l].outSize));
+        }
+        qBlockWeights = 0; qBlockScales = 0;
+        for (LayerDims& D : layers) {
+            D.pairs = (D.inSize + 1) / 2;
+            D.qOffset = qBlockWeights; D.sOffset = qBlockScales;
+            qBlockWeights += (size_t)D.outSize * D.pairs * 2 * LANES;
+            qBlockScales += (size_t)D.outSize * LANES;
+        }
+
+        params.assign(blockParams * numBlocks, 0.f); // unused lanes stay zero
+        inputs.assign((size_t)numBlocks * layers[0].inSize * LANES, 0.f);
+        scratch.assign(scratchSize(), 0.f);
+        outputs.assign(numAgents, 0.f);
+        if (mode == InferenceMode::Int8) { // each loadAgent quantizes its own lane
+            qweights.assign(qBlockWeights * numBlocks, 0);
+            qscales.assign(qBlockScales * numBlocks, 0.f);
+        }
+
+        for (int a = 0; a < numAgents; a++) {
+            loadAgent(a, *nets[a]);
+        }
+    }
+
+    // -- Switch precision (quantizes the loaded genomes when entering Int8) --
+    void setMode(InferenceMode m) {
+        mode = m;
+        if (mode == InferenceMode::Int8) quantize();
+    }
+
+    // -- Refresh one agent's genome (same topology as the batch) --
+    void loadAgent(int agent, const Net& net) {
+        float* block = params.data() + (size_t)(agent / LANES) * blockParams;
+        const int lane = agent % LANES;
+        for (size_t l = 0; l < layers.size(); l++) {
+            const LayerDims& D = layers[l];
+            const Layer& L = net.layers[l];
+            const float* w = net.params.data() + L.weightOffset();
+            const float* b = net.params.data() + L.biasOffset();
+            float* W = block + D.offset;
+            float* B = W + (size_t)D.outSize * D.inSize * LANES;
+            for (int o = 0; o < D.outSize; o++) {
+                for (int i = 0; i < D.inSize; i++) {
+                    W[((size_t)o * D.inSize + i) * LANES + lane] = w[(size_t)o * D.inSize + i];
+                }
+                B[(size_t)o * LANES + lane] = b[o];
+            }
+        }
+        if (mode == InferenceMode::Int8) quantizeLane(agent / LANES, lane);
+    }
+
+    // -- Int8 weights from the fp32 batch (only when genomes change) --
+    void quantize() {
+        qweights.assign(qBlockWeights * numBlocks, 0);
+        qscales.assign(qBlockScales * numBlocks, 0.f);
+        for (int a = 0; a < numAgents; a++) quantizeLane(a / LANES, a % LANES);
+    }
+
+    // Symmetric per-neuron scale: the largest |weight| of a row maps to 127
+    void quantizeLane(int blk, int lane) {
+        if (qweights.size() != qBlockWeights * numBlocks) { quantize(); return; }
+        const float* P = params.data() + (size_t)blk * blockParams;
+        int8_t* Q = qweights.data() + (size_t)blk * qBlockWeights;
+        float* S = qscales.data() + (size_t)blk * qBlockScales;
+        for (size_t l = 0; l < layers.size(); l++) {
+            const LayerDims& D = layers[l];
+            const float* W = P + D.offset;
+            const float inScale = l == 0 ? Q_INPUT_SCALE : Q_HIDDEN_SCALE;
+            for (int o = 0; o < D.outSize; o++) {
+                float amax = 0.f;
+                for (int i = 0; i < D.inSize; i++) amax = std::max(amax, std::fabs(W[((size_t)o * D.inSize + i) * LANES + lane]));
+                const float step = amax > 0.f ? amax / 127.f : 1.f; // weight per int8 unit
+                int8_t* q = Q + D.qOffset + (size_t)o * D.pairs * 2 * LANES;
+                for (int i = 0; i < D.pairs * 2; i++) {
+                    float w = i < D.inSize ? W[((size_t)o * D.inSize + i) * LANES + lane] : 0.f;
+                    q[((size_t)(i / 2) * LANES + lane) * 2 + (i & 1)] = (int8_t)std::lrint(w / step);
+                }
+                S[D.sOffset + (size_t)o * LANES + lane] = step / inScale; // int32 sum -> real value
+            }
+        }
+    }
+
+    // -- Copy the genome in row `from` over row `to` (used to pack the living into the first rows) --
+    void moveRow(int from, int to) {
+        const size_t perLane = blockParams / LANES; // floats of one agent in a block
+        const float* src = params.data() + (size_t)(from / LANES) * blockParams + from % LANES;
+        float* dst = params.data() + (size_t)(to / LANES) * blockParams + to % LANES;
+        for (size_t j = 0; j < perLane; j++) dst[j * LANES] = src[j * LANES];
+        if (mode == InferenceMode::Int8) {
+            const int8_t* qs = qweights.data() + (size_t)(from / LANES) * qBlockWeights + 2 * (from % LANES);
+            int8_t* qd = qweights.data() + (size_t)(to / LANES) * qBlockWeights + 2 * (to % LANES);
+            for (size_t j = 0; j < qBlockWeights / (2 * LANES); j++) { qd[j * 2 * LANES] = qs[j * 2 * LANES]; qd[j * 2 * LANES + 1] = qs[j * 2 * LANES + 1]; }
+            const float* ss = qscales.data() + (size_t)(from / LANES) * qBlockScales + from % LANES;
+            float* sd = qscales.data() + (size_t)(to / LANES) * qBlockScales + to % LANES;
+            for (size_t j = 0; j < qBlockScales / LANES; j++) sd[j * LANES] = ss[j * LANES];
+        }
+    }
+
+    int activeBlocks() const { return (activeRows + LANES - 1) / LANES; }
+
+    // -- Input k of one agent (row) --
+    float& input(int agent, int k) {
+        return inputs[((size_t)(agent / LANES) * layers[0].inSize + k) * LANES + agent % LANES];
+    }
+
+    // -- Evaluate every block with at least one live agent --
+    // alive holds one byte per agent (nullptr = everyone alive)
+    void forward(const uint8_t* alive) {
+        forwardBlocks(0, activeBlocks(), alive, scratch.data());
+    }
+
+    // -- Evaluate blocks [b0, b1), scratch holds scratchSize() floats --
+    // Two fp32 activation buffers, then room for one int16 pair buffer
+    size_t scratchSize() const { return (size_t)2 * maxWidth * LANES + (size_t)(maxWidth + 1) * LANES; }
+
+    void forwardBlocks(int b0, int b1, const uint8_t* alive, float* work) {
+        if (mode == InferenceMode::Int8) { forwardBlocksInt8(b0, b1, alive, work); return; }
+        const Kernel dense = kernel();
+        const bool fast = mode == InferenceMode::FastTanh;
+        for (int blk = b0; blk < b1; blk++) {
+            if (alive && !blockAlive(blk, alive)) continue; // whole block dead
+
+            const float* P = params.data() + (size_t)blk * blockParams;
+            const float* x = inputs.data() + (size_t)blk * layers[0].inSize * LANES;
+            float* bufs[2] = {work, work + (size_t)maxWidth * LANES}; // ping-pong activations
+            int cur = 0;
+            for (const LayerDims& D : layers) {
+                const float* W = P + D.offset;
+                const float* B = W + (size_t)D.outSize * D.inSize * LANES;
+                float* y = bufs[cur];
+                dense(W, B, x, y, D.inSize, D.outSize);
+                const int n = D.outSize * LANES;
+                if (fast) { for (int k = 0; k < n; k++) y[k] = Net::actFast(y[k]); } // vectorized rational
+                else { for (int k = 0; k < n; k++) y[k] = Net::act(y[k]); } // exact tanh, matches Net
+                x = y; cur ^= 1;
+            }
+
+            const int first = blk * LANES; // lane 0 of output neuron 0
+            const int count = std::min(LANES, numAgents - first);
+            for (int l = 0; l < count; l++) outputs[first + l] = x[l];
+        }
+    }
+
+    // -- Int8 path: quantize activations to int16 pairs, int32 dot products, fp32 bias + tanh --
+    void forwardBlocksInt8(int b0, int b1, const uint8_t* alive, float* work) {
+        const QKernel dense = qkernel();
+        float* y = work; // fp32 layer output
+        int16_t* xq = (int16_t*)(work + (size_t)2 * maxWidth * LANES); // [pair][lane][2]
+        for (int blk = b0; blk < b1; blk++) {
+            if (alive && !blockAlive(blk, alive)) continue; // whole block dead
+
+            const float* P = params.data() + (size_t)blk * blockParams;
+            const int8_t* Q = qweights.data() + (size_t)blk * qBlockWeights;
+            const float* S = qscales.data() + (size_t)blk * qBlockScales;
+            quantizeActivations(inputs.data() + (size_t)blk * layers[0].inSize * LANES,
+                                layers[0].inSize, Q_INPUT_SCALE, xq);
+            for (size_t l = 0; l < layers.size(); l++) {
+                const LayerDims& D = layers[l];
+                const float* B = P + D.offset + (size_t)D.outSize * D.inSize * LANES;
+                dense(Q + D.qOffset, S + D.sOffset, B, xq, y, D.pairs, D.outSize);
+                const int n = D.outSize * LANES;
+                for (int k = 0; k < n; k++) y[k] = Net::actFast(y[k]);
+                if (l + 1 < layers.size()) quantizeActivations(y, D.outSize, Q_HIDDEN_SCALE, xq);
+            }
+
+            const int first = blk * LANES; // lane 0 of output neuron 0
+            const int count = std::min(LANES, numAgents - first);
+            for (int l = 0; l < count; l++) outputs[first + l] = y[l];
+        }
+    }
+
+    // x[i][lane] (fp32) -> xq[i / 2][lane][i % 2] (int16, saturated), odd tail zeroed.
+    // Each (even, odd) pair of one lane is one little-endian 32-bit word.
+    static void quantizeActivations(const float* x, int in, float scale, int16_t* xq) {
+        qquantizer()(x, in, scale, (uint32_t*)xq);
+    }
+
+    bool blockAlive(int blk, const uint8_t* alive) const {
+        const int first = blk * LANES, last = std::min(numAgents, first + LANES);
+        for (int a = first; a < last; a++) if (alive[a]) return true;
+        return false;
+    }
+
+    // == Dense layer kernels: y[o][lane] = B[o][lane] + sum_i W[o][i][lane] * x[i][lane] ==
+    using Kernel = void (*)(const float*, const float*, const float*, float*, int, int);
+
+    static void denseScalar(const float* W, const float* B, const float* x, float* y, int in, int out) {
+        for (int o = 0; o < out; o++) {
+            float acc[LANES]; // one accumulator per lane (auto-vectorizes)
+            for (int l = 0; l < LANES; l++) acc[l] = B[o * LANES + l];
+            const float* w = W + (size_t)o * in * LANES;
+            for (int i = 0; i < in; i++) {
+                for (int l = 0; l < LANES; l++) acc[l] += w[i * LANES + l] * x[i * LANES + l];
+            }
+            for (int l = 0; l < LANES; l++) y[o * LANES + l] = acc[l];
+        }
+    }
+
+#ifdef NRR_X86_SIMD
+    __attribute__((target("avx2,fma")))
+    static void denseAvx2(const float* W, const float* B, const float* x, float* y, int in, int out) {
+        for (int o = 0; o < out; o++) {
+            __m256 a0 = _mm256_load_ps(B + o * LANES);
+            __m256 a1 = _mm256_load_ps(B + o * LANES + 8);
+            const float* w = W + (size_t)o * in * LANES;
+            for (int i = 0; i < in; i++) {
+                a0 = _mm256_fmadd_ps(_mm256_load_ps(w + i * LANES), _mm256_load_ps(x + i * LANES), a0);
+                a1 = _mm256_fmadd_ps(_mm256_load_ps(w + i * LANES + 8), _mm256_load_ps(x + i * LANES + 8), a1);
+            }
+            _mm256_store_ps(y + o * LANES, a0);
+            _mm256_store_ps(y + o * LANES + 8, a1);
+        }
+    }
+
+    __attribute__((target("avx512f")))
+    static void denseAvx512(const float* W, const float* B, const float* x, float* y, int in, int out) {
+        for (int o = 0; o < out; o++) {
+            __m512 a = _mm512_load_ps(B + o * LANES);
+            const float* w = W + (size_t)o * in * LANES;
+            for (int i = 0; i < in; i++) {
+                a = _mm512_fmadd_ps(_mm512_load_ps(w + i * LANES), _mm512_load_ps(x + i * LANES), a);
+            }
+            _mm512_store_ps(y + o * LANES, a);
+        }
+    }
+#endif
+
+    // == Quantized kernels: y[o][lane] = B[o][lane] + S[o][lane] * sum_p (W[o][p][lane] . x[p][lane]) ==
+    // Each pair is two int8 weights times two int16 activations summed into
+    // int32, which is exactly one pmaddwd lane.
+    using QKernel = void (*)(const int8_t*, const float*, const float*, const int16_t*, float*, int, int);
+
+    static void qdenseScalar(const int8_t* W, const float* S, const float* B, const int16_t* x, float* y, int pairs, int out) {
+        for (int o = 0; o < out; o++) {
+            int32_t acc[LANES] = {}; // one accumulator per lane
+            const int8_t* w = W + (size_t)o * pairs * 2 * LANES;
+            for (int k = 0; k < pairs * 2 * LANES; k += 2) {
+                acc[(k / 2) % LANES] += (int32_t)w[k] * x[k] + (int32_t)w[k + 1] * x[k + 1];
+            }
+            for (int l = 0; l < LANES; l++) y[o * LANES + l] = B[o * LANES + l] + S[o * LANES + l] * (float)acc[l];
+        }
+    }
+
+#ifdef NRR_X86_SIMD
+    __attribute__((target("avx2,fma")))
+    static void qdenseAvx2(const int8_t* W, const float* S, const float* B, const int16_t* x, float* y, int pairs, int out) {
+        for (int o = 0; o < out; o++) {
+            __m256i a0 = _mm256_setzero_si256(), a1 = _mm256_setzero_si256(); // lanes 0-7, 8-15
+            const int8_t* w = W + (size_t)o * pairs * 2 * LANES;
+            for (int p = 0; p < pairs; p++) {
+                const int8_t* wp = w + p * 2 * LANES;
+                const int16_t* xp = x + p * 2 * LANES;
+                __m256i w0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)wp));
+                __m256i w1 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(wp + 16)));
+                a0 = _mm256_add_epi32(a0, _mm256_madd_epi16(w0, _mm256_loadu_si256((const __m256i*)xp)));
+                a1 = _mm256_add_epi32(a1, _mm256_madd_epi16(w1, _mm256_loadu_si256((const __m256i*)(xp + 16))));
+            }
+            _mm256_store_ps(y + o * LANES, _mm256_fmadd_ps(_mm256_cvtepi32_ps(a0), _mm256_load_ps(S + o * LANES), _mm256_load_ps(B + o * LANES)));
+            _mm256_store_ps(y + o * LANES + 8, _mm256_fmadd_ps(_mm256_cvtepi32_ps(a1), _mm256_load_ps(S + o * LANES + 8), _mm256_load_ps(B + o * LANES + 8)));
+        }
+    }
+
+    __attribute__((target("avx512f,avx512bw")))
+    static void qdenseAvx512(const int8_t* W, const float* S, const float* B, const int16_t* x, float* y, int pairs, int out) {
+        for (int o = 0; o < out; o++) {
+            __m512i a = _mm512_setzero_si512();
+            const int8_t* w = W + (size_t)o * pairs * 2 * LANES;
+            for (int p = 0; p < pairs; p++) {
+                __m512i wv = _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)(w + p * 2 * LANES)));
+                a = _mm512_add_epi32(a, _mm512_madd_epi16(wv, _mm512_loadu_si512(x + p * 2 * LANES)));
+            }
+            _mm512_store_ps(y + o * LANES, _mm512_fmadd_ps(_mm512_cvtepi32_ps(a), _mm512_load_ps(S + o * LANES), _mm512_load_ps(B + o * LANES)));
+        }
+    }
+#endif
+
+    using Quantizer = void (*)(const float*, int, float, uint32_t*);
+
+    static void quantizeScalar(const float* x, int in, float scale, uint32_t* xq) {
+        for (int p = 0; p < (in + 1) / 2; p++) {
+            for (int l = 0; l < LANES; l++) {
+                float v0 = std::min(32767.f, std::max(-32767.f, x[(2 * p) * LANES + l] * scale));
+                float v1 = 2 * p + 1 < in ? std::min(32767.f, std::max(-32767.f, x[(2 * p + 1) * LANES + l] * scale)) : 0.f;
+                uint32_t q0 = (uint16_t)(int16_t)std::lrint(v0), q1 = (uint16_t)(int16_t)std::lrint(v1);
+                xq[p * LANES + l] = q0 | (q1 << 16);
+            }
+        }
+    }
+
+#ifdef NRR_X86_SIMD
+    __attribute__((target("avx2")))
+    static void quantizeAvx2(const float* x, int in, float scale, uint32_t* xq) {
+        const __m256 s = _mm256_set1_ps(scale), hi = _mm256_set1_ps(32767.f), lo = _mm256_set1_ps(-32767.f);
+        const __m256i mask = _mm256_set1_epi32(0xFFFF);
+        for (int p = 0; p < (in + 1) / 2; p++) {
+            for (int h = 0; h < LANES; h += 8) {
+                __m256i q0 = _mm256_cvtps_epi32(_mm256_min_ps(hi, _mm256_max_ps(lo, _mm256_mul_ps(_mm256_load_ps(x + (2 * p) * LANES + h), s))));
+                __m256i q1 = _mm256_setzero_si256();
+                if (2 * p + 1 < in) q1 = _mm256_cvtps_epi32(_mm256_min_ps(hi, _mm256_max_ps(lo, _mm256_mul_ps(_mm256_load_ps(x + (2 * p + 1) * LANES + h), s))));
+                _mm256_storeu_si256((__m256i*)(xq + p * LANES + h), _mm256_or_si256(_mm256_and_si256(q0, mask), _mm256_slli_epi32(q1, 16)));
+            }
+        }
+    }
+
+    __attribute__((target("avx512f")))
+    static void quantizeAvx512(const float* x, int in, float scale, uint32_t* xq) {
+        const __m512 s = _mm512_set1_ps(scale), hi = _mm512_set1_ps(32767.f), lo = _mm512_set1_ps(-32767.f);
+        const __m512i mask = _mm512_set1_epi32(0xFFFF);
+        for (int p = 0; p < (in + 1) / 2; p++) {
+            __m512i q0 = _mm512_cvtps_epi32(_mm512_min_ps(hi, _mm512_max_ps(lo, _mm512_mul_ps(_mm512_load_ps(x + (2 * p) * LANES), s))));
+            __m512i q1 = _mm512_setzero_si512();
+            if (2 * p + 1 < in) q1 = _mm512_cvtps_epi32(_mm512_min_ps(hi, _mm512_max_ps(lo, _mm512_mul_ps(_mm512_load_ps(x + (2 * p + 1) * LANES), s))));
+            _mm512_storeu_si512(xq + p * LANES, _mm512_or_si512(_mm512_and_si512(q0, mask), _mm512_slli_epi32(q1, 16)));
+        }
+    }
+#endif
+
+    static Quantizer qquantizer() {
+        static const Quantizer q = [] {
+#ifdef NRR_X86_SIMD
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) return (Quantizer)quantizeAvx512;
+            if (__builtin_cpu_supports("avx2")) return (Quantizer)quantizeAvx2;
+#endif
+            return (Quantizer)quantizeScalar;
+        }();
+        return q;
+    }
+
+    static QKernel qkernel() {
+        static const QKernel k = [] {
+#ifdef NRR_X86_SIMD
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512bw")) return (QKernel)qdenseAvx512;
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return (QKernel)qdenseAvx2;
+#endif
+            return (QKernel)qdenseScalar;
+        }();
+        return k;
+    }
+
+    // -- Pick the widest kernel the CPU supports (resolved once) --
+    static Kernel kernel() {
+        static const Kernel k = [] {
+#ifdef NRR_X86_SIMD
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) return (Kernel)denseAvx512;
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return (Kernel)denseAvx2;
+#endif
+            return (Kernel)denseScalar;
+        }();
+        return k;
+    }
+    static const char* kernelName() {
+#ifdef NRR_X86_SIMD
+        if (kernel() == (Kernel)denseAvx512) return "avx512";
+        if (kernel() == (Kernel)denseAvx2) return "avx2";
+#endif
+        return "scalar";
+    }
+};
+
+#ifdef NRR_POP_DIAGNOSTICS
+#pragma GCC diagnostic pop
+#undef NRR_POP_DIAGNOSTICS
+#endif
@@ -0,0 +1,162 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using std::vector;
+
+// == Scoped phase timers ==
+// PROFILE_SCOPE("name") times the rest of the enclosing block. Builds without
+// NRR_PROFILE compile every scope away, so the hot paths carry no cost unless
+// profiling was asked for (-DNRR_PROFILE). Names must be string literals.
+//
+// Each thread records into its own ring buffer (single writer, no locks on
+// the hot path). Readers (trace dump, HUD overlay) copy the ring while it is
+// being written and drop entries the writer may have overwritten meanwhile.
+
+struct ProfileEvent {
+    const char* name = nullptr; // phase (string literal)
+    uint64_t startNs = 0; // steady clock, ns
+    uint64_t durNs = 0; // duration, ns
+};
+
+struct ProfileRing {
+    static constexpr uint64_t CAPACITY = 1 << 16; // events kept per thread
+    ProfileEvent events[CAPACITY];
+    std::atomic<uint64_t> head{0}; // events ever written
+    int tid = 0; // small thread id for the trace
+
+    void push(const char* name, uint64_t start, uint64_t dur) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        ProfileEvent& e = events[h & (CAPACITY - 1)];
+        e.name = name; e.startNs = start; e.durNs = dur;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // Append the events still intact in the ring to out (oldest first)
+    void snapshot(vector<ProfileEvent>& out) const {
+        const uint64_t end = head.load(std::memory_order_acquire);
+        const uint64_t begin = end > CAPACITY ? end - CAPACITY : 0;
+        const size_t first = out.size();
+        for (uint64_t i = begin; i < end; ++i) out.push_back(events[i & (CAPACITY - 1)]);
+        // Entries the writer reached (or was writing) while we copied may be torn
+        const uint64_t now = head.load(std::memory_order_acquire) + 1;
+        const uint64_t stale = now > CAPACITY + begin ? std::min(now - CAPACITY - begin, end - begin) : 0;
+        out.erase(out.begin() + first, out.begin() + first + (size_t)stale);
+    }
+};
+
+// Rolling statistics of one phase
+struct PhaseStat {
+    const char* name = nullptr; // phase
+    double p50Ms = 0.0, p99Ms = 0.0; // percentiles over the window
+    int count = 0; // samples in the window
+};
+
+struct Profiler {
+    std::mutex m; // guards rings (registration only)
+    vector<std::unique_ptr<ProfileRing>> rings; // one per recording thread, never freed before exit
+
+    static Profiler& instance() { static Profiler p; return p; }
+
+    static uint64_t nowNs() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // This thread's ring (registered on first use)
+    static ProfileRing& ring() {
+        thread_local ProfileRing* r = nullptr;
+        if (!r) {
+            Profiler& p = instance();
+            std::lock_guard<std::mutex> lock(p.m);
+            p.rings.emplace_back(new ProfileRing());
+            r = p.rings.back().get();
+            r->tid = (int)p.rings.size();
+        }
+        return *r;
+    }
+
+    // Copy every thread's recorded events, tids[i] is the thread of out[i]
+    void collect(vector<ProfileEvent>& out, vector<int>& tids) {
+        out.clear(); tids.clear();
+        std::lock_guard<std::mutex> lock(m);
+        for (const auto& r : rings) {
+            size_t before = out.size();
+            r->snapshot(out);
+            tids.insert(tids.end(), out.size() - before, r->tid);
+        }
+    }
+
+    // -- Rolling p50/p99 per phase over events that ended in the last windowMs --
+    void phaseStats(double windowMs, vector<PhaseStat>& stats) {
+        vector<ProfileEvent> events; vector<int> tids;
+        collect(events, tids);
+        const uint64_t cutoff = nowNs() - (uint64_t)(windowMs * 1e6);
+        stats.clear();
+        vector<const char*> names;
+        for (const ProfileEvent& e : events) {
+            if (e.startNs + e.durNs < cutoff) continue;
+            bool seen = false;
+            for (const char* n : names) seen = seen || strcmp(n, e.name) == 0;
+            if (!seen) names.push_back(e.name);
+        }
+        vector<double> d;
+        for (const char* n : names) {
+            d.clear();
+            for (const ProfileEvent& e : events) {
+                if (e.startNs + e.durNs >= cutoff && strcmp(n, e.name) == 0) d.push_back(e.durNs * 1e-6);
+            }
+            auto pct = [&](double q) {
+                size_t k = std::min(d.size() - 1, (size_t)(q * (double)d.size()));
+                std::nth_element(d.begin(), d.begin() + k, d.end());
+                return d[k];
+            };
+            PhaseStat s;
+            s.name = n; s.count = (int)d.size();
+            s.p50Ms = pct(0.50); s.p99Ms = pct(0.99);
+            stats.push_back(s);
+        }
+    }
+
+    // -- Chrome trace_event JSON (chrome://tracing, Perfetto), returns false on I/O failure --
+    bool dumpChromeTrace(const std::string& path) {
+        vector<ProfileEvent> events; vector<int> tids;
+        collect(events, tids);
+        FILE* f = fopen(path.c_str(), "w");
+        if (!f) return false;
+        fprintf(f, "{\"traceEvents\": [\n");
+        for (size_t i = 0; i < events.size(); ++i) {
+            const ProfileEvent& e = events[i];
+            fprintf(f, "%s{\"name\": \"%s\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": %d}\n",
+                    i ? "," : "", e.name, e.startNs * 1e-3, e.durNs * 1e-3, tids[i]);
+        }
+        fprintf(f, "], \"displayTimeUnit\": \"ms\"}\n");
+        return fclose(f) == 0;
+    }
+};
+
+// -- RAII timer behind PROFILE_SCOPE --
+struct ProfileScope {
+    const char* name;
+    uint64_t start;
+    explicit ProfileScope(const char* n) : name(n), start(Profiler::nowNs()) {}
+    ~ProfileScope() { Profiler::ring().push(name, start, Profiler::nowNs() - start); }
+};
+
+#ifdef NRR_PROFILE
+#define NRR_PROFILE_CONCAT2(a, b) a##b
+#define NRR_PROFILE_CONCAT(a, b) NRR_PROFILE_CONCAT2(a, b)
+#define PROFILE_SCOPE(name) ProfileScope NRR_PROFILE_CONCAT(profileScope_, __LINE__)(name)
+constexpr bool PROFILING_ENABLED = true;
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+constexpr bool PROFILING_ENABLED = false;
+#endif
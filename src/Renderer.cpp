@@ -0,0 +1,79 @@
+#include "Renderer.hpp"
+
+void Renderer::releaseText() {
+    for (TextLine& l : lines) {
+        if (l.texture) SDL_DestroyTexture(l.texture);
+    }
+    lines.clear();
+}
+
+static SDL_Vertex vertex(float x, float y, SDL_Color c) {
+    SDL_Vertex v; // untextured vertex
+    v.position = SDL_FPoint{x, y};
+    v.color = c;
+    v.tex_coord = SDL_FPoint{0.f, 0.f};
+    return v;
+}
+
+// -- Walls: a strip of quads per wall, one quad between neighbouring columns --
+void Renderer::addWalls(const Cave& cave, int W, int H, SDL_Color color) {
+    if (W <= 0) return;
+    const int base = (int)vertices.size(); // first vertex of the strips
+    const int cols = W + 1; // column edges 0..W
+    vertices.reserve(vertices.size() + 4 * cols);
+    indices.reserve(indices.size() + 12 * W);
+
+    for (int xp = 0; xp < cols; ++xp) { // per column: ceiling pair then floor pair
+        float t, b; cave.sample(W, H, (float)xp, t, b); // sample cave once
+        vertices.push_back(vertex((float)xp, 0.f, color)); // screen top
+        vertices.push_back(vertex((float)xp, t, color)); // top wall edge
+        vertices.push_back(vertex((float)xp, b, color)); // bottom wall edge
+        vertices.push_back(vertex((float)xp, (float)H, color)); // screen bottom
+    }
+    for (int xp = 0; xp < W; ++xp) { // two quads per column span
+        const int a = base + 4 * xp, n = a + 4; // this column, next column
+        const int quad[12] = {a, n, a + 1, a + 1, n, n + 1, // ceiling
+                              a + 2, n + 2, a + 3, a + 3, n + 2, n + 3}; // floor
+        indices.insert(indices.end(), quad, quad + 12);
+    }
+}
+
+// -- Arrow: triangle pointing along (dirX, dirY), rotated without trig calls --
+void Renderer::addArrow(float x, float y, float dirX, float dirY, float size, SDL_Color color) {
+    const float half = size * 0.5f; // half size
+    auto rot = [&](float px, float py) { // rotate offset (px, py) and translate to (x, y)
+        return vertex(px * dirX - py * dirY + x, px * dirY + py * dirX + y, color);
+    };
+    const int base = (int)vertices.size();
+    vertices.push_back(rot(size, 0.f)); // tip
+    vertices.push_back(rot(-half, -half)); // bottom rear
+    vertices.push_back(rot(-half, half)); // top rear
+    indices.push_back(base); indices.push_back(base + 1); indices.push_back(base + 2);
+}
+
+void Renderer::flush() {
+    if (!indices.empty()) {
+        SDL_RenderGeometry(sdl, nullptr, vertices.data(), (int)vertices.size(),
+                           indices.data(), (int)indices.size()); // whole frame in one call
+    }
+    begin();
+}
+
+void Renderer::text(int slot, const char* str, int x, int y) {
+    if (slot >= (int)lines.size()) lines.resize(slot + 1);
+    TextLine& l = lines[slot];
+    if (!l.texture || l.text != str) { // re-render only on change
+        if (l.texture) SDL_DestroyTexture(l.texture);
+        l.texture = nullptr;
+        l.text = str;
+        SDL_Color color = {255, 255, 255, 255}; // white color
+        SDL_Surface* surface = TTF_RenderText_Blended(font, str, color); // create surface
+        if (!surface) return;
+        l.texture = SDL_CreateTextureFromSurface(sdl, surface); // create texture
+        l.w = surface->w; l.h = surface->h;
+        SDL_FreeSurface(surface); // free the surface
+        if (!l.texture) return;
+    }
+    SDL_Rect dest = {x, y, l.w, l.h}; // destination rectangle
+    SDL_RenderCopy(sdl, l.texture, nullptr, &dest); // render the cached texture
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <string>
+#include <vector>
+
+#include "Cave.hpp"
+
+using std::vector;
+
+// == Batched 2D renderer ==
+// Walls and agents are appended to one persistent vertex/index buffer during
+// the frame and submitted with a single SDL_RenderGeometry call, so the cost
+// per frame no longer grows with one driver call per line or per agent. The
+// buffers keep their capacity between frames (no steady-state allocation).
+// HUD lines are rendered to textures once and reused until their text changes.
+struct Renderer {
+    // -- One cached HUD line --
+    struct TextLine {
+        std::string text; // text the texture was rendered from
+        SDL_Texture* texture = nullptr; // cached texture (nullptr = none yet)
+        int w = 0, h = 0; // texture size
+    };
+
+    SDL_Renderer* sdl = nullptr; // target renderer
+    TTF_Font* font = nullptr; // HUD font
+    vector<SDL_Vertex> vertices; // this frame's geometry
+    vector<int> indices; // triangles into vertices
+    vector<TextLine> lines; // HUD texture cache, by slot
+
+    Renderer(SDL_Renderer* r, TTF_Font* f) : sdl(r), font(f) {}
+    ~Renderer() { releaseText(); }
+    Renderer(const Renderer&) = delete;
+    Renderer& operator=(const Renderer&) = delete;
+
+    // -- Geometry (queued until flush) --
+    void begin() { vertices.clear(); indices.clear(); }
+    void addWalls(const Cave& cave, int W, int H, SDL_Color color); // both walls as two strips
+    void addArrow(float x, float y, float dirX, float dirY, float size, SDL_Color color); // dir = unit vector
+    void flush(); // submit everything queued in one call
+
+    // -- HUD: draw text in a slot, re-rendering its texture only when it changed --
+    void text(int slot, const char* str, int x, int y);
+    void releaseText(); // free cached textures (before destroying the SDL renderer)
+};
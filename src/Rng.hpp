@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+// == Counter-based random numbers ==
+// Every value is a pure function of (key, counter): no sequential state is
+// shared, so any thread can draw the numbers of any (seed, generation, child)
+// independently and reproducibly.
+
+// SplitMix64 finalizer: a strong 64-bit bijective mix
+inline uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Random 64 bits for counter ctr of stream key
+inline uint64_t counterHash(uint64_t key, uint64_t ctr) {
+    return mix64(key ^ mix64(ctr));
+}
+
+// Combine several identifiers into one stream key
+inline uint64_t streamKey(uint64_t a, uint64_t b, uint64_t c = 0) {
+    return mix64(mix64(mix64(a) ^ b) ^ c);
+}
+
+// Key of the mutation applied to child `child` of generation `generation`
+inline uint64_t mutationKey(uint64_t seed, uint64_t generation, uint64_t child) {
+    return streamKey(seed, generation, child);
+}
+
+// Seed of the cave flown in generation `generation` (a stream separate from the mutations)
+inline unsigned caveSeed(uint64_t seed, uint64_t generation) {
+    return (unsigned)streamKey(seed ^ 0xC2B2AE3D27D4EB4Full, generation);
+}
+
+// Uniform float in [0, 1) from 24 random bits
+inline float toUniform(uint64_t bits) { return (float)(bits >> 40) * (1.0f / 16777216.0f); }
+// Uniform float in (0, 1] (safe for log)
+inline float toUniformOpen(uint64_t bits) { return (float)((bits >> 40) + 1) * (1.0f / 16777216.0f); }
+
+// == Sequential view of one counter stream ==
+struct CounterRng {
+    uint64_t key = 0; // stream
+    uint64_t ctr = 0; // position in the stream
+
+    CounterRng(uint64_t k, uint64_t start = 0) : key(k), ctr(start) {}
+    uint64_t next() { return counterHash(key, ctr++); }
+    float uniform() { return toUniform(next()); }
+    float uniformOpen() { return toUniformOpen(next()); }
+};
+
+// == Standard normal samples out[0..n) of stream key, element i depends only on (key, i) ==
+// Box-Muller over pairs, written as flat batch loops the compiler can vectorize.
+inline void gaussianFill(uint64_t key, float* out, int n) {
+    constexpr int BATCH = 64; // pairs per batch
+    const float twoPi = 6.28318530718f;
+    float u1[BATCH], u2[BATCH];
+    for (int base = 0; base < n; base += 2 * BATCH) {
+        const int pairs = std::min(BATCH, (n - base + 1) / 2);
+        const uint64_t pair0 = (uint64_t)base / 2;
+        for (int p = 0; p < pairs; ++p) { // uniforms (integer hashing)
+            u1[p] = toUniformOpen(counterHash(key, 2 * (pair0 + p)));
+            u2[p] = toUniform(counterHash(key, 2 * (pair0 + p) + 1));
+        }
+        for (int p = 0; p < pairs; ++p) { // transform
+            float r = std::sqrt(-2.f * std::log(u1[p]));
+            float a = twoPi * u2[p];
+            u1[p] = r * std::cos(a);
+            u2[p] = r * std::sin(a);
+        }
+        for (int p = 0; p < pairs; ++p) {
+            int i = base + 2 * p;
+            out[i] = u1[p];
+            if (i + 1 < n) out[i + 1] = u2[p];
+        }
+    }
+}
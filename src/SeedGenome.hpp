@@ -0,0 +1,229 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Agent.hpp"
+
+using std::vector;
+
+// == Seed-chain genomes ==
+// A genome is the seed of its initial weights plus the mutations applied since
+// (counter-stream key, sigma, probability). Weights are a pure function of
+// that chain (Net(sizes, initSeed), then Net::mutate for every record), so a
+// genome can be stored or sent as 16 bytes per generation and rebuilt on
+// demand. Records live in shared links: a child adds one link pointing at its
+// parent's, so the whole population shares its history instead of copying it.
+
+struct MutationRecord {
+    uint64_t key = 0; // mutation stream (see mutationKey)
+    float sigma = 0.f; // noise scale
+    float prob = 0.f; // per-parameter mutation probability
+};
+
+struct SeedLink {
+    MutationRecord rec; // the mutation this link adds
+    std::shared_ptr<const SeedLink> prev; // parent's last link (null = straight from the init seed)
+    uint64_t hash = 0; // identity of the chain up to and including this link
+    uint32_t depth = 0; // records up to and including this one
+
+    SeedLink() = default;
+    SeedLink(const SeedLink&) = delete;
+    SeedLink& operator=(const SeedLink&) = delete;
+
+    // Release the chain iteratively: letting each link's prev destroy the next
+    // one would recurse once per generation and overflow the stack on long runs.
+    // A link is only unlinked here when this was its last owner.
+    ~SeedLink() {
+        std::shared_ptr<const SeedLink> link = std::move(prev);
+        while (link && link.use_count() == 1) {
+            std::shared_ptr<const SeedLink> next = std::move(const_cast<SeedLink&>(*link).prev);
+            link = std::move(next); // frees the old link, whose prev is already empty
+        }
+    }
+};
+
+// Links by chain hash, so genomes read back share their common history again
+using SeedLinkIndex = std::unordered_map<uint64_t, std::shared_ptr<const SeedLink>>;
+
+struct SeedGenome {
+    uint32_t initSeed = 0; // Net(sizes, initSeed) before any mutation
+    std::shared_ptr<const SeedLink> last; // newest record (null = no mutations)
+
+    SeedGenome() = default;
+    explicit SeedGenome(uint32_t seed) : initSeed(seed) {}
+
+    int length() const { return last ? (int)last->depth : 0; }
+    uint64_t hash() const { return last ? last->hash : mix64(0x5EED000000000000ull | initSeed); }
+
+    // -- This genome plus one more mutation (shares every earlier link) --
+    SeedGenome child(const MutationRecord& rec) const {
+        auto link = std::make_shared<SeedLink>();
+        uint32_t bits[2];
+        memcpy(&bits[0], &rec.sigma, 4); memcpy(&bits[1], &rec.prob, 4);
+        link->rec = rec;
+        link->prev = last;
+        link->hash = streamKey(hash(), rec.key, (uint64_t)bits[0] << 32 | bits[1]);
+        link->depth = (uint32_t)length() + 1;
+        SeedGenome g(initSeed);
+        g.last = std::move(link);
+        return g;
+    }
+
+    // Records oldest first
+    void records(vector<MutationRecord>& out) const {
+        out.resize(length());
+        size_t k = out.size();
+        for (const SeedLink* l = last.get(); l; l = l->prev.get()) out[--k] = l->rec;
+    }
+
+    // -- Rebuild the weights from scratch (see GenomeCache for the incremental path) --
+    Net build(const vector<int>& sizes) const {
+        Net net(sizes, initSeed);
+        vector<MutationRecord> recs;
+        records(recs);
+        for (const MutationRecord& r : recs) net.mutate(r.key, r.sigma, r.prob);
+        return net;
+    }
+
+    // -- Byte form (little-endian): u32 initSeed, u32 count, count x (u64 key, f32 sigma, f32 prob) --
+    size_t byteSize() const { return 8 + 16 * (size_t)length(); }
+
+    void write(vector<uint8_t>& out) const {
+        vector<MutationRecord> recs;
+        records(recs);
+        auto put = [&](uint64_t v, int bytes) { for (int i = 0; i < bytes; ++i) out.push_back((uint8_t)(v >> (8 * i))); };
+        put(initSeed, 4);
+        put(recs.size(), 4);
+        for (const MutationRecord& r : recs) {
+            uint32_t s, p;
+            memcpy(&s, &r.sigma, 4); memcpy(&p, &r.prob, 4);
+            put(r.key, 8); put(s, 4); put(p, 4);
+        }
+    }
+
+    // Parse one genome at data[pos], advancing pos; false if the bytes run out
+    // Links already in *shared are reused instead of duplicated (new ones are added).
+    static bool read(const uint8_t* data, size_t size, size_t& pos, SeedGenome& g, SeedLinkIndex* shared = nullptr) {
+        auto get = [&](int bytes) { uint64_t v = 0; for (int i = 0; i < bytes; ++i) v |= (uint64_t)data[pos++] << (8 * i); return v; };
+        if (pos > size || size - pos < 8) return false;
+        g = SeedGenome((uint32_t)get(4));
+        const uint64_t count = get(4);
+        if ((size - pos) / 16 < count) return false;
+        for (uint64_t k = 0; k < count; ++k) {
+            MutationRecord r;
+            r.key = get(8);
+            uint32_t s = (uint32_t)get(4), p = (uint32_t)get(4);
+            memcpy(&r.sigma, &s, 4); memcpy(&r.prob, &p, 4);
+            g = g.child(r);
+            if (shared) g.last = shared->emplace(g.last->hash, g.last).first->second;
+        }
+        return true;
+    }
+};
+
+// Links held by a set of genomes (shared history counted once)
+inline size_t countLinks(const vector<SeedGenome>& genomes) {
+    std::unordered_set<const SeedLink*> seen;
+    for (const SeedGenome& g : genomes) {
+        for (const SeedLink* l = g.last.get(); l && seen.insert(l).second; l = l->prev.get()) {}
+    }
+    return seen.size();
+}
+
+// == LRU cache of rebuilt weights ==
+// get() returns a genome's weights, replaying only the records after the
+// newest link already cached: a child of last generation's parent costs one
+// weight copy and one mutation, an elite costs nothing.
+struct GenomeCache {
+    struct Entry {
+        uint64_t hash;
+        Net net;
+    };
+    vector<int> sizes; // network topology
+    size_t capacity = 256; // weight sets kept (at least 2)
+    std::list<Entry> lru; // most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+    uint64_t hits = 0, misses = 0, replayed = 0; // statistics (replayed = mutations applied)
+
+    GenomeCache(const vector<int>& layerSizes, size_t cap) : sizes(layerSizes), capacity(std::max<size_t>(2, cap)) {}
+
+    // Weights of g (valid until the next get)
+    const Net& get(const SeedGenome& g) {
+        auto it = index.find(g.hash());
+        if (it != index.end()) { // exact hit
+            ++hits;
+            lru.splice(lru.begin(), lru, it->second);
+            return lru.front().net;
+        }
+        ++misses;
+
+        // Walk back to the newest cached ancestor (or the init seed)
+        thread_local vector<const SeedLink*> pending;
+        pending.clear();
+        const Net* base = nullptr;
+        for (const SeedLink* l = g.last.get(); l; l = l->prev.get()) {
+            auto found = index.find(l->hash);
+            if (found != index.end()) {
+                lru.splice(lru.begin(), lru, found->second); // keep the base away from eviction
+                base = &lru.front().net;
+                break;
+            }
+            pending.push_back(l);
+        }
+        if (!base) { // the chain's root may be cached too
+            auto found = index.find(SeedGenome(g.initSeed).hash());
+            if (found != index.end()) { lru.splice(lru.begin(), lru, found->second); base = &lru.front().net; }
+        }
+
+        // Slot for the result: recycle the least recently used entry's buffers once full
+        if (lru.size() >= capacity) {
+            auto victim = std::prev(lru.end());
+            index.erase(victim->hash);
+            lru.splice(lru.begin(), lru, victim);
+            if (base) lru.front().net.copyWeightsFrom(*base);
+            else lru.front().net = Net(sizes, g.initSeed);
+        } else {
+            lru.push_front(base ? Entry{0, *base} : Entry{0, Net(sizes, g.initSeed)});
+        }
+        Entry& e = lru.front();
+        for (size_t k = pending.size(); k-- > 0;) {
+            const MutationRecord& r = pending[k]->rec;
+            e.net.mutate(r.key, r.sigma, r.prob);
+        }
+        replayed += pending.size();
+        e.hash = g.hash();
+        index[e.hash] = lru.begin();
+        return e.net;
+    }
+
+    double hitRate() const { return hits + misses ? (double)hits / (double)(hits + misses) : 0.0; }
+};
+
+// Evolve a population of seed-chain genomes, fitness[i] scoring genomes[i]
+// Same selection and rng draws as evolve, so rebuilding the new genomes gives
+// exactly the agents evolve would have produced; no weights are touched here.
+inline GenStats evolveChains(vector<SeedGenome>& genomes, vector<SeedGenome>& next, const vector<float>& fitness,
+        EvolveBuffers& buf, std::mt19937& rng, uint64_t seed, int eliteCount, float mutationSigma,
+        float mutationProb, int& generation, float& bestFitness) {
+    PROFILE_SCOPE("evolve");
+    const int n = (int)genomes.size();
+    eliteCount = std::min(eliteCount, n);
+    GenStats stats = selectParents(fitness, buf, rng, eliteCount, generation, bestFitness);
+    next.resize(n);
+    for (int i = 0; i < eliteCount; ++i) next[i] = genomes[buf.order[i]];
+    for (int k = eliteCount; k < n; ++k) {
+        MutationRecord r;
+        r.key = mutationKey(seed, (uint64_t)generation, (uint64_t)k);
+        r.sigma = mutationSigma;
+        r.prob = mutationProb;
+        next[k] = genomes[buf.parents[k]].child(r);
+    }
+    genomes.swap(next);
+    generation++;
+    return stats;
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "Cave.hpp"
+
+using std::vector;
+
+// == Shared per-frame sensing field ==
+// Every agent stands at the same x and casts the same ray fan into the same
+// cave, so the walls a ray can meet do not depend on the agent. Once per frame
+// we build the wall heightfield ahead of the agents and, for each ray angle,
+// the running envelope of the corridor seen along the ray:
+//   lo[k] = max_{j<=k} (top(x_j) - j*dy),   hi[k] = min_{j<=k} (bot(x_j) - j*dy)
+// A ray leaving height y survives step k exactly when lo[k] <= y <= hi[k]; lo
+// only grows and hi only shrinks, so the hit step is a binary search. Sensing
+// then costs O(visible width + rays * steps) per frame plus O(log steps) per
+// ray and agent, instead of agents * rays * steps cave samples.
+struct SensorField {
+    // Maximum wall error (px) of the interpolated heightfield. The column
+    // spacing is derived from the cave's curvature bound; <= 0 samples the cave
+    // exactly at every ray step (still shared by all agents).
+    // This bounds wall heights, not ray distances: a ray only ends at another
+    // step than castRay's where one of its samples lies within the tolerance of
+    // a wall, but a ray grazing a wall may then run on for many steps.
+    float tolerance = 0.05f;
+
+    float originX = 0.f; // screen X the rays start from
+    float spacing = 1.f; // heightfield column spacing (px)
+    float fieldX0 = 0.f; // screen X of column 0
+    vector<float> tops, bots; // unclamped wall heights per column
+    float minTop = 0.f, maxBot = 0.f; // cave margins, applied after interpolation
+
+    int numRays = 0; // rays in the fan
+    int steps = 0; // marching steps per ray (ceil(maxDist / step))
+    float step = 0.f; // ray step length (px)
+    vector<float> lo, hi; // corridor envelopes [ray][step]
+
+    // -- Build the field for one frame --
+    void build(const Cave& cave, int W, int H, float ox, const float* angles, int rays,
+               float maxDist, float rayStep) {
+        originX = ox; numRays = rays; step = rayStep;
+        steps = 0;
+        for (float d = 0.f; d < maxDist; d += rayStep) ++steps; // same count as castRay
+
+        // Horizontal extent reached by the fan
+        float xMin = ox, xMax = ox;
+        for (int r = 0; r < rays; ++r) {
+            float reach = cosf(angles[r]) * rayStep * (float)steps;
+            xMin = std::min(xMin, ox + reach); xMax = std::max(xMax, ox + reach);
+        }
+
+        const bool exact = tolerance <= 0.f;
+        if (!exact) buildHeightfield(cave, H, xMin, xMax);
+
+        lo.resize((size_t)rays * steps); hi.resize((size_t)rays * steps);
+        for (int r = 0; r < rays; ++r) {
+            float dx = cosf(angles[r]) * rayStep; // delta x per step
+            float dy = sinf(angles[r]) * rayStep; // delta y per step
+            float x = ox, yOff = 0.f; // march exactly like castRay
+            float L = -1e30f, U = 1e30f; // running envelope
+            float* rl = lo.data() + (size_t)r * steps;
+            float* rh = hi.data() + (size_t)r * steps;
+            for (int k = 0; k < steps; ++k) {
+                float t, b;
+                if (exact) cave.sample(W, H, x, t, b);
+                else wallsAt(x, t, b);
+                L = std::max(L, t - yOff); U = std::min(U, b - yOff);
+                rl[k] = L; rh[k] = U;
+                x += dx; yOff += dy; // advance ray
+            }
+        }
+    }
+
+    // -- Distance travelled by ray r from height y (same quantization as castRay) --
+    float distance(int r, float y) const {
+        const float* rl = lo.data() + (size_t)r * steps;
+        const float* rh = hi.data() + (size_t)r * steps;
+        int first = 0, last = steps; // first step where y leaves the corridor
+        while (first < last) {
+            int mid = (first + last) >> 1;
+            if (y < rl[mid] || y > rh[mid]) last = mid;
+            else first = mid + 1;
+        }
+        return (float)first * step;
+    }
+
+    // -- Interpolated wall heights at screen X (within the built range) --
+    // Margins are applied after interpolating; clamping is 1-Lipschitz, so the
+    // smooth-wall error bound still holds
+    void wallsAt(float x, float& top, float& bot) const {
+        float u = (x - fieldX0) / spacing;
+        int i = std::max(0, std::min((int)tops.size() - 2, (int)u));
+        float f = std::min(1.f, std::max(0.f, u - (float)i));
+        top = std::max(minTop, tops[i] + (tops[i + 1] - tops[i]) * f);
+        bot = std::min(maxBot, bots[i] + (bots[i + 1] - bots[i]) * f);
+    }
+
+    // -- Column spacing meeting the tolerance for this cave --
+    float spacingFor(const Cave& cave, float xWorldMax) const {
+        // Linear interpolation error: c*h^2/8 on smooth walls, plus s*h/4 at the
+        // gap floor where the slope can jump by at most s
+        // (the column cache, when enabled, spends part of the budget)
+        const float c = std::max(1e-9f, cave.curvatureBound(xWorldMax));
+        const float s = 0.5f * cave.gapJitter * cave.gapFreq;
+        const float tol = std::max(1e-4f, tolerance - cave.cacheError(xWorldMax));
+        float h = (-s / 4.f + sqrtf(s * s / 16.f + c * tol / 2.f)) / (c / 4.f); // positive root
+        return std::max(0.25f, std::min(h, 32.f));
+    }
+
+    // -- Sample the smooth walls on evenly spaced columns covering [xMin, xMax] --
+    void buildHeightfield(const Cave& cave, int H, float xMin, float xMax) {
+        spacing = spacingFor(cave, cave.scroll + cave.startPhase + xMax);
+        fieldX0 = xMin;
+        minTop = cave.margin; maxBot = (float)H - cave.margin;
+        const int cols = (int)std::ceil((xMax - xMin) / spacing) + 2;
+        tops.resize(cols); bots.resize(cols);
+        for (int j = 0; j < cols; ++j) {
+            float xWorld = cave.scroll + fieldX0 + j * spacing + cave.startPhase;
+            float t, b;
+            cave.walls(xWorld, (float)H, t, b); // smooth walls, clamped on lookup
+            tops[j] = t; bots[j] = b;
+        }
+    }
+};
@@ -0,0 +1,406 @@
+#pragma once
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include "Cave.hpp"
+#include "Agent.hpp"
+#include "PopulationNet.hpp"
+#include "SensorField.hpp"
+#include "ThreadPool.hpp"
+#include "Profiler.hpp"
+#include "FitnessMemo.hpp"
+
+using std::vector;
+
+// == Constants ==
+static constexpr int   NUM_RAYS = 7; // number of rays cast for sensing
+static constexpr float RAY_FOV  = 1.2f; // total FOV in radians
+static constexpr float RAY_MAX  = 700.f; // max ray distance
+static constexpr float RAY_STEP = 4.f; // ray marching step size
+static constexpr int   NUM_INPUTS = NUM_RAYS + 2; // rays + offset + velocity
+static_assert(AgentFixedNet::INPUTS == NUM_INPUTS, "AgentFixedNet must match the sensor count");
+
+static const int   POP_SIZE    = 50; // population size
+static const int   ELITE_COUNT = 5; // number of elite agents preserved each generation
+static const float MUT_PROB    = 0.15f; // mutation probability
+static const float MUT_SIGMA   = 0.30f; // mutation strength
+
+static const float VX = 220.f;  // horizontal scroll speed (px/s)
+static const float VY = 200.f;  // max vertical speed (px/s)
+
+static const int MAX_STEP_SCALE = 2; // largest --step-scale a trained policy flies within 3% of 1/60 s (tools/ccd_check)
+
+static const float PIXELS_PER_POINT = 50.f; // scoring resolution
+static const float ARROW_SIZE       = 20.f; // size of the agent arrow
+
+// == Ray casting function ==
+inline float castRay(const Cave& cave, int W, int H, float ox, float oy,
+                     float angle, float maxDist = RAY_MAX, float step = RAY_STEP) {
+    float dx = cosf(angle) * step; // delta x per step
+    float dy = sinf(angle) * step; // delta y per step
+    float x = ox, y = oy, dist = 0.f; // initialize position and distance
+    while (dist < maxDist) { // while within max distance
+        float topY, botY; // cave boundaries
+        cave.sample(W, H, x, topY, botY); // sample cave at current x
+        if (y < topY || y > botY) break; // collision detected
+        x += dx; y += dy; dist += step; // advance ray
+    }
+    return dist; // return distance traveled
+}
+
+// == Observation of one runner: normalized ray distances, corridor offset, velocity ==
+// Writes NUM_INPUTS values to obs and returns the corridor offset (used by the fitness shaping).
+inline float encodeObservation(const float* rayDists, float y, float vy, float senseTop, float senseBot, float* obs) {
+    float center = 0.5f*(senseTop + senseBot); // cave center
+    float halfGap = 0.5f*(senseBot - senseTop); // half gap size
+    float offSetNorm = (halfGap > 1.f) ? (y - center)/halfGap : 0.f; // normalized offset
+    float velNorm = std::max(-1.f, std::min(1.f, vy / VY)); // normalized velocity
+    for (int r = 0; r < NUM_RAYS; ++r){ // for each ray
+        obs[r] = std::min(1.f, rayDists[r]/RAY_MAX); // normalized distance
+    }
+    obs[NUM_RAYS] = offSetNorm; // normalized offset
+    obs[NUM_RAYS + 1] = velNorm; // normalized velocity
+    return offSetNorm;
+}
+
+// == Control, fitness shaping and collision of one runner for action a (tanh output in [-1, 1]) ==
+// t0/b0 are the walls at the runner's x; returns true if it hit one.
+inline bool moveRunner(float a, bool manual, float offSetNorm, float dt, int H, float t0, float b0,
+                       float& y, float& vy, float& fitnessAcc) {
+    // -- Control (proportional velocity) --
+    if (manual) {
+        vy = VY; // max upward speed
+    }
+    else {
+        vy = a * VY; // set vertical speed
+    }
+    y -= vy * dt; // update vertical position
+    if (y < ARROW_SIZE) {
+        y = ARROW_SIZE; // top boundary
+    }
+    if (y > H - ARROW_SIZE) {
+        y = H - ARROW_SIZE; // bottom boundary
+    }
+
+    // -- Fitness shaping (gentle) --
+    fitnessAcc += dt * (1.0f - 0.1f * fabsf(offSetNorm) - 0.001f * a * a); // reward center and smoothness
+
+    // -- Collision --
+    return y < t0 || y > b0; // collision check
+}
+
+// == Runner state as columns, with a compacted list of the living ==
+// One entry per agent in each column. live holds the indices of the agents
+// still running (in no particular order) and livePos the position of each
+// agent in it, so a death is an O(1) swap-remove and per-step loops touch
+// only the living.
+struct Runners {
+    vector<float> y; // vertical position
+    vector<float> vy; // vertical velocity
+    vector<float> fitnessAcc; // accumulated fitness shaping
+    vector<uint8_t> alive; // alive status
+    vector<int> live; // indices of living agents
+    vector<int> livePos; // position in live (-1 = dead)
+    vector<int> deathStep; // step count when the agent died (-1 = alive)
+    vector<int> deathScore; // shared score when it died
+    vector<float> deathScroll; // cave scroll when it died (the survival term)
+
+    size_t size() const { return y.size(); }
+
+    void reset(size_t n, float y0) {
+        y.assign(n, y0); vy.assign(n, 0.f); fitnessAcc.assign(n, 0.f);
+        alive.assign(n, 1);
+        deathStep.assign(n, -1); deathScore.assign(n, 0); deathScroll.assign(n, 0.f);
+        live.resize(n); livePos.resize(n);
+        for (size_t i = 0; i < n; ++i) { live[i] = (int)i; livePos[i] = (int)i; }
+    }
+
+    // Remove agent i from the live list (O(1): the last living agent takes its slot)
+    void kill(int i) {
+        const int pos = livePos[i];
+        if (pos < 0) return;
+        const int last = live.back();
+        live[pos] = last; livePos[last] = pos;
+        live.pop_back(); livePos[i] = -1;
+        alive[i] = 0;
+    }
+};
+
+// == Angle of ray r in the forward-locked fan ==
+inline float rayAngle(int r) {
+    const float angleForward = 0.0f; // straight ahead (world +X)
+    float t = (NUM_RAYS == 1) ? 0.5f : (float)r / (float)(NUM_RAYS - 1); // normalized [0,1]
+    return angleForward - (RAY_FOV * 0.5f) + t * RAY_FOV; // ray angle
+}
+
+// == Simulation state shared by the visual and headless front ends ==
+struct Simulation {
+    int   W = 800, H = 600; // world size
+    float x = 240.f; // fixed X for all agents
+    int   score = 0; // current score
+    float pxAcc = 0.f; // pixel accumulator for scoring
+    int   steps = 0; // steps simulated in this generation
+    int   bestAliveIdx = -1; // best alive agent (for highlight)
+    Cave  cave; // current cave
+    Runners runners; // per-agent state columns and the live list
+    vector<float> offsets; // normalized corridor offset per agent (fitness shaping)
+    PopulationNet batch; // all brains, evaluated together each step
+    vector<int> agentRow; // batch row of each agent
+    vector<int> rowAgent; // agent in each batch row
+    vector<uint8_t> rowAlive; // alive mask over batch rows
+    bool compactBatch = true; // repack living agents into the first batch rows as the dead pile up
+    bool sweptCollision = false; // also test the path between steps against the moving walls (large dt)
+    SensorField field; // per-step ray envelopes shared by all agents
+    bool useField = true; // false -> march every ray (reference path)
+    float rayAngles[NUM_RAYS]; // fixed ray fan
+    float senseTop = 0.f, senseBot = 0.f; // corridor slightly ahead of the agents
+    float scrollBefore = 0.f; // cave scroll at the start of the current step
+    ThreadPool* pool = nullptr; // optional workers for the per-agent phases (not owned)
+    vector<AlignedFloats> workScratch; // per-worker activation buffers
+    vector<uint8_t> diedNow; // agents that died during the last step
+    vector<int> deaths; // agents that died during the last step, in index order
+    FitnessMemo* memo = nullptr; // optional outcomes of earlier flights (not owned), see flightParams
+    uint64_t memoParams = 0; // flightParams() of the current run
+    vector<uint64_t> genomeKeys; // genomeHash of each agent's brain (memo only)
+    int replayUntil = 0; // last death step of the agents answered by the memo
+
+    static constexpr int AGENT_GRAIN = 256; // agents per parallel chunk
+    static constexpr int BLOCK_GRAIN = 16; // network blocks per parallel chunk
+    static constexpr int COMPACT_MIN_ROWS = 4 * PopulationNet::LANES; // smaller batches are not worth repacking
+
+    Simulation() {
+        for (int r = 0; r < NUM_RAYS; ++r) rayAngles[r] = rayAngle(r);
+    }
+
+    // -- Reset the entire generation on a fresh cave --
+    void resetGeneration(vector<Agent>& agents, const Cave& baseCave) {
+        cave = baseCave; // assign to current cave
+        const size_t n = agents.size();
+        float t,b; cave.sample(W,H,x,t,b); // sample cave
+        runners.reset(n, 0.5f*(t+b)); // everyone alive, centered on the corridor
+        diedNow.assign(n, 0);
+        deaths.clear();
+        offsets.assign(n, 0.f);
+        vector<const Net*> nets; nets.reserve(n); // brains of the new generation
+        for (const Agent& a : agents) nets.push_back(&a.brain);
+        batch.load(nets);
+        agentRow.resize(n); rowAgent.resize(n);
+        for (size_t i = 0; i < n; ++i) { agentRow[i] = (int)i; rowAgent[i] = (int)i; }
+        rowAlive.assign(n, 1);
+        for (Agent& a : agents) a.fitness = 0.f; // reset fitness
+        score = 0; pxAcc = 0.f; // reset score
+        steps = 0; bestAliveIdx = -1; // reset counters
+        replayUntil = 0;
+        if (memo) { // genomes already flown on this cave start dead with their old fitness
+            memo->nextGeneration();
+            genomeKeys.resize(n);
+            for (size_t i = 0; i < n; ++i) {
+                genomeKeys[i] = genomeHash(agents[i].brain);
+                MemoEntry e;
+                if (!memo->find(memoKey((int)i), e)) continue;
+                agents[i].fitness = e.fitness;
+                runners.fitnessAcc[i] = e.shaping;
+                runners.deathScroll[i] = e.survival;
+                runners.deathScore[i] = e.deathScore;
+                runners.deathStep[i] = e.deathStep;
+                rowAlive[i] = 0;
+                runners.kill((int)i);
+                replayUntil = std::max(replayUntil, e.deathStep); // keeps the score counting as if it flew
+            }
+        }
+    }
+
+    // -- Everything besides genome and cave a flight's outcome depends on --
+    uint64_t flightParams(float dt, int maxSteps) const {
+        uint32_t bits[3];
+        const float f[3] = {x, dt, useField ? field.tolerance : -1.f};
+        memcpy(bits, f, sizeof(bits));
+        uint64_t h = streamKey((uint64_t)W << 32 | (uint32_t)H, (uint64_t)bits[0] << 32 | bits[1], bits[2]);
+        if (sweptCollision) h = mix64(h ^ 0xCCD);
+        return streamKey(h, (uint64_t)maxSteps, (uint64_t)batch.mode);
+    }
+
+    MemoKey memoKey(int i) const { return MemoKey{genomeKeys[i], cave.seed, memoParams}; }
+
+    // Outcome of agent i's flight (after its death) as stored in the memo
+    MemoEntry outcome(int i, const Agent& a) const {
+        MemoEntry e;
+        e.fitness = a.fitness;
+        e.shaping = runners.fitnessAcc[i];
+        e.survival = runners.deathScroll[i];
+        e.deathScore = runners.deathScore[i];
+        e.deathStep = runners.deathStep[i];
+        return e;
+    }
+
+    // -- Final fitness of an agent dying right now (at cave scroll `scroll` with `points` scored) --
+    float deathFitness(int i, float scroll, int points) const {
+        float survivalBonus = scroll; // survival bonus based on distance
+        return runners.fitnessAcc[i] + survivalBonus + (float)points * 50.f; // total fitness
+    }
+    float deathFitness(int i) const { return deathFitness(i, cave.scroll, score); }
+
+    // -- Agent i dies now (stepCount = steps flown): final fitness and its components --
+    // scroll < 0 = the current scroll and score (swept collisions pass their values at the contact)
+    void recordDeath(int i, Agent& a, int stepCount, float scroll = -1.f, int points = 0) {
+        if (scroll < 0.f) { scroll = cave.scroll; points = score; }
+        a.fitness = deathFitness(i, scroll, points);
+        runners.deathStep[i] = stepCount;
+        runners.deathScore[i] = points;
+        runners.deathScroll[i] = scroll;
+    }
+
+    // -- Kill every remaining agent (used to cap generation length) --
+    void killAll(vector<Agent>& agents) {
+        while (!runners.live.empty()) {
+            const int i = runners.live.back();
+            recordDeath(i, agents[i], steps);
+            if (memo) memo->store(memoKey(i), outcome(i, agents[i]));
+            rowAlive[agentRow[i]] = 0;
+            runners.kill(i);
+        }
+        bestAliveIdx = -1;
+    }
+
+    // -- Move the living agents into the first batch rows (after enough deaths) --
+    // Rows are filled in ascending order of their current row, so every source
+    // row is at or after its destination and nothing is overwritten early.
+    void compactRows() {
+        vector<int>& live = runners.live;
+        std::sort(live.begin(), live.end(), [&](int a, int b) { return agentRow[a] < agentRow[b]; });
+        for (size_t k = 0; k < live.size(); ++k) {
+            const int i = live[k], from = agentRow[i], to = (int)k;
+            runners.livePos[i] = to;
+            if (from == to) continue;
+            batch.moveRow(from, to);
+            agentRow[i] = to; rowAgent[to] = i; rowAlive[to] = 1;
+        }
+        for (int r = (int)live.size(); r < batch.activeRows; ++r) rowAlive[r] = 0;
+        batch.activeRows = (int)live.size();
+    }
+
+    // -- Cast the rays of one agent and write its network inputs, returns the corridor offset --
+    float sense(int i) {
+        const float y = runners.y[i], vy = runners.vy[i]; // runner state
+        const int row = agentRow[i]; // batch row holding this agent's inputs
+        // -- Sensing (forward-locked FOV for stability) --
+        float rayDists[NUM_RAYS]; // ray data
+        for (int r = 0; r < NUM_RAYS; ++r) { // for each ray
+            rayDists[r] = useField ? field.distance(r, y) // shared envelope lookup
+                                   : castRay(cave, W, H, x, y, rayAngles[r], RAY_MAX, RAY_STEP); // cast ray
+        }
+
+        float obs[NUM_INPUTS]; // network inputs
+        const float offSetNorm = encodeObservation(rayDists, y, vy, senseTop, senseBot, obs);
+        for (int k = 0; k < NUM_INPUTS; ++k) batch.input(row, k) = obs[k];
+        return offSetNorm;
+    }
+
+    // -- Run body(begin, end, worker) over [0, n) on the pool, or inline without one --
+    template <class F>
+    void parallelFor(int n, int grain, F&& body) {
+        if (pool) pool->parallelFor(n, grain, body);
+        else if (n > 0) body(0, n, 0);
+    }
+
+    // -- Advance all agents by dt, returns false once everyone is dead --
+    bool step(vector<Agent>& agents, float dt, bool manual = false) {
+        PROFILE_SCOPE("step");
+        // Keep the cave column cache covering the screen and the ray fan
+        {
+            PROFILE_SCOPE("step/cave");
+            float span = std::max((float)W, x + RAY_MAX) + 1.f;
+            if (cave.columns.mask == 0 || cave.columns.xHi != span) cave.enableCache(0.f, span);
+
+            // Update cave scroll once per step
+            scrollBefore = cave.scroll;
+            cave.update(VX, dt);
+
+            // Cave queries shared by every agent this step
+            if (useField) field.build(cave, W, H, x, rayAngles, NUM_RAYS, RAY_MAX, RAY_STEP);
+            cave.sample(W, H, x + 30.f, senseTop, senseBot); // sample slightly ahead
+        }
+        float t0, b0; cave.sample(W, H, x, t0, b0); // sample cave at agent x
+
+        const vector<int>& live = runners.live; // only the living are touched below
+        const int nLive = (int)live.size();
+        bool anyAlive = nLive > 0 || steps < replayUntil; // at least one alive (flown or remembered)
+
+        // -- Sensing: fill the batched network inputs --
+        {
+            PROFILE_SCOPE("step/sense");
+            parallelFor(nLive, AGENT_GRAIN, [&](int begin, int end, int) {
+                for (int k = begin; k < end; ++k) { // for each living agent
+                    const int i = live[k];
+                    offsets[i] = sense(i);
+                }
+            });
+        }
+
+        // -- Neural Network Decision (rows of the living, whole blocks at once) --
+        {
+            PROFILE_SCOPE("step/inference");
+            const int workers = pool ? pool->size() : 1;
+            if ((int)workScratch.size() < workers) workScratch.resize(workers);
+            for (AlignedFloats& w : workScratch) if (w.size() < batch.scratchSize()) w.resize(batch.scratchSize());
+            parallelFor(batch.activeBlocks(), BLOCK_GRAIN, [&](int begin, int end, int worker) {
+                batch.forwardBlocks(begin, end, rowAlive.data(), workScratch[worker].data());
+            });
+        }
+
+        // -- Control, fitness and collision --
+        {
+            PROFILE_SCOPE("step/physics");
+            parallelFor(nLive, AGENT_GRAIN, [&](int begin, int end, int) {
+                for (int k = begin; k < end; ++k) { // for each living agent
+                    const int i = live[k];
+                    float a = batch.outputs[agentRow[i]]; // tanh ∈ [-1,1]
+                    const float y0 = runners.y[i];
+                    bool hit = moveRunner(a, manual, offsets[i], dt, H, t0, b0, runners.y[i], runners.vy[i], runners.fitnessAcc[i]);
+                    float deathScroll = -1.f, contact; // -1 = the current scroll; contact = fraction of the step flown
+                    int deathScore = 0;
+                    if (sweptCollision && cave.sweep(H, x, scrollBefore, cave.scroll, y0, runners.y[i], contact)) {
+                        hit = true;
+                        deathScroll = scrollBefore + contact * (cave.scroll - scrollBefore);
+                        deathScore = score + (int)((pxAcc + (deathScroll - scrollBefore)) / PIXELS_PER_POINT); // points of the part flown
+                    }
+                    if (hit) {
+                        diedNow[i] = 1; // removed from the live list below
+                        recordDeath(i, agents[i], steps + 1, deathScroll, deathScore); // total fitness
+                    }
+                }
+            });
+        }
+
+        // -- Serial reduction over the living (independent of thread count) --
+        PROFILE_SCOPE("step/reduce");
+        deaths.clear();
+        for (int k = 0; k < nLive; ++k) {
+            if (diedNow[live[k]]) deaths.push_back(live[k]);
+        }
+        std::sort(deaths.begin(), deaths.end()); // death ordering by index
+        for (int i : deaths) { // O(1) each
+            diedNow[i] = 0;
+            if (memo) memo->store(memoKey(i), outcome(i, agents[i]));
+            rowAlive[agentRow[i]] = 0;
+            runners.kill(i);
+        }
+        // Track best alive (for highlight): highest fitness, lowest index on ties
+        bestAliveIdx = -1; float bestAliveFit = -1e9f;
+        for (int i : live) {
+            float f = agents[i].fitness;
+            if (f > bestAliveFit || (f == bestAliveFit && i < bestAliveIdx)) { bestAliveFit = f; bestAliveIdx = i; }
+        }
+        // Repack the batch once at most half of its rows are still alive
+        if (compactBatch && batch.activeRows >= COMPACT_MIN_ROWS && (int)live.size() * 2 <= batch.activeRows) compactRows();
+
+        // Score (distance-based, shared)
+        if (anyAlive) { // if at least one alive
+            pxAcc += VX * dt; // accumulate pixels
+            while (pxAcc >= PIXELS_PER_POINT) { score += 1; pxAcc -= PIXELS_PER_POINT; } // update score
+        }
+        ++steps;
+        return anyAlive;
+    }
+};
@@ -0,0 +1,131 @@
+#include "SimThread.hpp"
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+double SimThread::clockSeconds() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+SimThread::SimThread(int population, ThreadPool* pool) : rng(std::random_device{}()) {
+    runSeed = rng(); // keys the counter-based mutation and cave streams
+    agents.reserve(population); // agent population
+    for (int i = 0; i < population; ++i) { // for each agent
+        agents.emplace_back(NUM_INPUTS, (unsigned)rng()); // create agents
+    }
+    sim.pool = pool;
+    sim.resetGeneration(agents, Cave(caveSeed(runSeed, (uint64_t)generation))); // initial generation reset
+    prevY.resize(agents.size());
+    for (size_t i = 0; i < agents.size(); ++i) prevY[i] = sim.runners.y[i];
+    prevScroll = sim.cave.scroll;
+    std::string error;
+    telemetry.open("", error); // echo only
+    generationStart = clockSeconds();
+    publish(generationStart, 1.f, 0.f); // something to draw right away
+}
+
+// -- One fixed step, evolving when the whole population died --
+void SimThread::stepOnce() {
+    sim.W = viewW.load(memory_order_relaxed); // track window size
+    sim.H = viewH.load(memory_order_relaxed);
+    for (size_t i = 0; i < agents.size(); ++i) prevY[i] = sim.runners.y[i]; // for interpolation
+    prevScroll = sim.cave.scroll;
+
+    bool anyAlive = sim.step(agents, dt, manual.load(memory_order_relaxed)); // advance one step
+    ++stepCount;
+
+    // If everyone died -> evolve & new generation
+    if (!anyAlive) {
+        if (sim.score > highScore) highScore = sim.score; // update high score
+
+        // Evolve population
+        const uint32_t flown = caveSeed(runSeed, (uint64_t)generation);
+        GenStats st = evolve(agents, evolveBuffers, rng, runSeed, ELITE_COUNT, MUT_SIGMA, MUT_PROB,
+                             generation, bestFitnessEver, sim.pool); // evolve agents
+        const double now = clockSeconds();
+        GenerationRecord rec;
+        rec.generation = st.generation;
+        rec.caveSeed = flown;
+        rec.best = st.best; rec.avg = st.avg; rec.worst = st.worst;
+        rec.score = sim.score; rec.highScore = highScore; rec.steps = sim.steps;
+        rec.population = (int)agents.size();
+        rec.seconds = (float)(now - generationStart);
+        telemetry.generation(rec); // no formatting or I/O on the sim thread
+        generationStart = now;
+
+        // Reset world & runners for the new generation (nothing to interpolate from)
+        sim.resetGeneration(agents, Cave(caveSeed(runSeed, (uint64_t)generation)));
+        for (size_t i = 0; i < agents.size(); ++i) prevY[i] = sim.runners.y[i];
+        prevScroll = sim.cave.scroll;
+    }
+}
+
+// -- Copy the renderer's view of the world into the triple buffer --
+void SimThread::publish(double now, float alpha, float stepsPerSec) {
+    PROFILE_SCOPE("publish");
+    Snapshot& s = snapshots.writeSlot(); // vectors keep their capacity between publishes
+    s.step = stepCount;
+    s.generation = generation;
+    s.score = sim.score;
+    s.highScore = std::max(highScore, sim.score);
+    s.population = (int)agents.size();
+    s.bestAliveIdx = sim.bestAliveIdx;
+    s.x = sim.x;
+    s.cave = sim.cave;
+    s.prevScroll = prevScroll;
+    s.y.resize(agents.size()); s.vy.resize(agents.size()); s.alive.resize(agents.size());
+    for (size_t i = 0; i < agents.size(); ++i) {
+        s.y[i] = sim.runners.y[i];
+        s.vy[i] = sim.runners.vy[i];
+        s.alive[i] = sim.runners.alive[i];
+    }
+    s.prevY = prevY;
+    s.publishedAt = now;
+    s.alpha0 = alpha;
+    s.dt = dt;
+    s.speed = speed.load(memory_order_relaxed);
+    s.stepsPerSec = stepsPerSec;
+    snapshots.publish();
+}
+
+// == Thread body: fixed steps paced against the wall clock ==
+void SimThread::run() {
+    const double maxFrame = 0.25; // never try to catch up on more than this (s)
+    const double publishEvery = 1.0 / 120.0; // publish at least this often while flat out (s)
+    double last = clockSeconds();
+    double budget = 0.0; // simulated seconds owed
+    double rateStart = last; uint64_t rateSteps = stepCount; float stepsPerSec = 0.f; // rate meter
+
+    while (!quit.load(memory_order_relaxed)) {
+        double now = clockSeconds();
+        int mult = speed.load(memory_order_relaxed);
+        if (mult > 0) budget += std::min(now - last, maxFrame) * mult;
+        last = now;
+
+        // Run the owed steps (or flat out), but hand the renderer fresh state regularly
+        double sliceEnd = now + (mult > 0 ? 4.0 * publishEvery : publishEvery);
+        bool stepped = false;
+        while ((mult <= 0 || budget >= dt) && !quit.load(memory_order_relaxed)) {
+            stepOnce();
+            stepped = true;
+            if (mult > 0) budget -= dt;
+            if (clockSeconds() >= sliceEnd) {
+                if (mult > 0) budget = std::min(budget, (double)dt); // can't keep up: drop backlog
+                break;
+            }
+        }
+
+        double t = clockSeconds();
+        if (t - rateStart >= 0.5) { // refresh the rate meter twice a second
+            stepsPerSec = (float)((stepCount - rateSteps) / (t - rateStart));
+            rateStart = t; rateSteps = stepCount;
+        }
+        if (stepped) publish(t, mult > 0 ? (float)(budget / dt) : 1.f, stepsPerSec);
+
+        if (mult > 0 && budget < dt) { // sleep until the next step is due
+            double wait = (dt - budget) / mult;
+            std::this_thread::sleep_for(chrono::duration<double>(std::min(wait, 0.005)));
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Sim.hpp"
+#include "Telemetry.hpp"
+#include "ThreadPool.hpp"
+#include "TripleBuffer.hpp"
+
+using std::vector;
+
+// == What the renderer needs from one simulation step ==
+struct Snapshot {
+    uint64_t step = 0; // steps simulated since start
+    int generation = 1; // generation counter
+    int score = 0, highScore = 0; // current and high score
+    int population = 0; // agents per generation
+    int bestAliveIdx = -1; // best alive agent (for highlight)
+    float x = 240.f; // fixed X for all agents
+    Cave cave; // cave after the last step
+    float prevScroll = 0.f; // cave scroll before the last step
+    vector<float> y, prevY, vy; // runner state after / before the last step
+    vector<uint8_t> alive; // alive mask
+    double publishedAt = 0.0; // wall clock (s) at publish
+    float alpha0 = 1.f; // fraction of the next step already accumulated at publish
+    float dt = 1.f / 60.f; // fixed timestep
+    int speed = 1; // speed multiplier (0 = max)
+    float stepsPerSec = 0.f; // measured simulation rate
+};
+
+// == Fixed-timestep simulation on its own thread (visual mode) ==
+// The sim advances in fixed dt steps at speed x real time (or flat out) and
+// publishes a Snapshot through a lock-free triple buffer after each batch of
+// steps. The renderer never waits on the simulation and interpolates between
+// the last two steps, so physics, scoring and fitness no longer depend on the
+// display's frame rate.
+struct SimThread {
+    float dt = 1.f / 60.f; // fixed timestep
+    std::atomic<int> speed{1}; // 1, 10, 100 ... (0 = as fast as possible)
+    std::atomic<bool> manual{false}; // SPACE override
+    std::atomic<int> viewW{800}, viewH{600}; // window size (world size)
+    std::atomic<bool> quit{false}; // stop request
+    TripleBuffer<Snapshot> snapshots; // sim -> renderer
+
+    // Owned by the sim thread once started
+    Simulation sim; // cave, runners and score
+    vector<Agent> agents; // agent population
+    EvolveBuffers evolveBuffers; // second population buffer
+    std::mt19937 rng; // initial weights and selection
+    uint64_t runSeed = 0; // keys the counter-based mutation and cave streams
+    int generation = 1; // generation counter
+    int highScore = 0; // high score
+    float bestFitnessEver = 0.f; // best fitness ever
+    vector<float> prevY; // runner heights before the current step
+    float prevScroll = 0.f; // cave scroll before the current step
+    uint64_t stepCount = 0; // steps since start
+    double generationStart = 0.0; // wall clock when the current generation began
+    Telemetry telemetry; // generation lines are printed by its writer, off the sim thread
+    std::thread thread;
+
+    SimThread(int population, ThreadPool* pool);
+    ~SimThread() { stop(); }
+
+    void start() { thread = std::thread([this] { run(); }); }
+    void stop() { quit = true; if (thread.joinable()) thread.join(); }
+
+    void run(); // thread body
+    void stepOnce(); // one fixed step (+ evolve when everyone died)
+    void publish(double now, float alpha, float stepsPerSec);
+
+    // -- Renderer side: seconds since the monotonic clock's epoch --
+    static double clockSeconds();
+};
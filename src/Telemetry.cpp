@@ -0,0 +1,270 @@
+#include "Telemetry.hpp"
+#include <chrono>
+#include <cstring>
+
+using namespace std;
+
+static const char MAGIC[8] = {'N', 'R', 'R', 'T', 'E', 'L', '1', '\0'};
+static constexpr size_t MAX_BLOCK_ROWS = 1 << 24; // reader sanity limit
+
+const vector<TelemetryTable>& telemetrySchema() {
+    static const vector<TelemetryTable> schema = {
+        {"generations", {{"generation", ColumnType::Int}, {"cave_seed", ColumnType::Int},
+                         {"best", ColumnType::Float}, {"avg", ColumnType::Float}, {"worst", ColumnType::Float},
+                         {"score", ColumnType::Int}, {"high_score", ColumnType::Int}, {"steps", ColumnType::Int},
+                         {"population", ColumnType::Int}, {"seconds", ColumnType::Float}}},
+        {"agents", {{"generation", ColumnType::Int}, {"agent", ColumnType::Int}, {"cave_seed", ColumnType::Int},
+                    {"fitness", ColumnType::Float}, {"shaping", ColumnType::Float}, {"survival", ColumnType::Float},
+                    {"death_score", ColumnType::Int}, {"death_step", ColumnType::Int}}},
+    };
+    return schema;
+}
+
+// == Column codecs ==
+static uint64_t intBits(int64_t v) { return (uint64_t)v; }
+static uint64_t floatBits(float f) { uint32_t u; memcpy(&u, &f, 4); return u; }
+
+static void putVarint(vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) { out.push_back((uint8_t)(v | 0x80)); v >>= 7; }
+    out.push_back((uint8_t)v);
+}
+
+static bool getVarint(const uint8_t* data, size_t size, size_t& pos, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= size) return false;
+        const uint8_t b = data[pos++];
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false; // more than 10 bytes
+}
+
+void encodeColumn(ColumnType type, const uint64_t* values, size_t n, vector<uint8_t>& out) {
+    uint64_t prev = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (type == ColumnType::Int) {
+            const uint64_t d = values[i] - prev; // wraps like int64 subtraction
+            putVarint(out, (d << 1) ^ (uint64_t)((int64_t)d >> 63)); // zigzag: small negatives stay small
+        } else {
+            const uint32_t x = (uint32_t)(values[i] ^ prev);
+            int lead = 0, trail = 0; // zero bytes at the top / bottom of x
+            if (x == 0) {
+                lead = 4;
+            } else {
+                while (!(x >> (24 - 8 * lead) & 0xFF)) ++lead;
+                while (!(x >> (8 * trail) & 0xFF)) ++trail;
+            }
+            out.push_back((uint8_t)(lead << 4 | trail));
+            for (int k = trail; k < 4 - lead; ++k) out.push_back((uint8_t)(x >> (8 * k)));
+        }
+        prev = values[i];
+    }
+}
+
+bool decodeColumn(ColumnType type, const uint8_t* data, size_t size, size_t n, uint64_t* values) {
+    uint64_t prev = 0;
+    size_t pos = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (type == ColumnType::Int) {
+            uint64_t z;
+            if (!getVarint(data, size, pos, z)) return false;
+            prev += (z >> 1) ^ (0 - (z & 1));
+        } else {
+            if (pos >= size) return false;
+            const int lead = data[pos] >> 4, trail = data[pos] & 0x0F;
+            ++pos;
+            if (lead + trail > 4 || (lead < 4 && size - pos < (size_t)(4 - lead - trail))) return false;
+            uint32_t x = 0;
+            for (int k = trail; k < 4 - lead; ++k) x |= (uint32_t)data[pos++] << (8 * k);
+            prev ^= x;
+        }
+        values[i] = prev;
+    }
+    return pos == size;
+}
+
+// == Writer ==
+static void put32(vector<uint8_t>& out, uint32_t v) { for (int i = 0; i < 4; ++i) out.push_back((uint8_t)(v >> (8 * i))); }
+
+bool Telemetry::open(const string& path, string& error) {
+    if (!path.empty()) {
+        file = fopen(path.c_str(), "wb");
+        if (!file) { error = "cannot open " + path; return false; }
+        vector<uint8_t> header(MAGIC, MAGIC + 8);
+        const vector<TelemetryTable>& schema = telemetrySchema();
+        put32(header, TELEMETRY_VERSION);
+        put32(header, (uint32_t)schema.size());
+        for (const TelemetryTable& t : schema) {
+            header.push_back((uint8_t)t.name.size());
+            header.insert(header.end(), t.name.begin(), t.name.end());
+            header.push_back((uint8_t)t.columns.size());
+            for (const TelemetryColumn& c : t.columns) {
+                header.push_back((uint8_t)c.type);
+                header.push_back((uint8_t)c.name.size());
+                header.insert(header.end(), c.name.begin(), c.name.end());
+            }
+        }
+        if (fwrite(header.data(), 1, header.size(), file) != header.size()) {
+            error = "cannot write " + path;
+            fclose(file); file = nullptr;
+            return false;
+        }
+        for (int t = 0; t < 2; ++t) block[t].assign(schema[t].columns.size() * TELEMETRY_BLOCK_ROWS, 0);
+    }
+    stop = false;
+    thread = std::thread([this] { run(); });
+    return true;
+}
+
+void Telemetry::generation(const GenerationRecord& r) {
+    if (!generations.push(r)) {
+        ++stalls;
+        while (!generations.push(r)) std::this_thread::yield();
+    }
+}
+
+void Telemetry::agent(const AgentRecord& r) {
+    if (!agents.push(r)) {
+        ++stalls;
+        while (!agents.push(r)) std::this_thread::yield();
+    }
+}
+
+void Telemetry::close() {
+    if (!thread.joinable()) return;
+    stop.store(true, memory_order_release);
+    thread.join(); // drains the rings first
+    if (file) {
+        for (int t = 0; t < 2; ++t) writeBlock(t);
+        bytes = (uint64_t)ftell(file);
+        if (fclose(file) != 0 && lastError.empty()) lastError = "close failed";
+        file = nullptr;
+    }
+}
+
+void Telemetry::append(int table, const uint64_t* row) {
+    const size_t cols = telemetrySchema()[table].columns.size();
+    for (size_t c = 0; c < cols; ++c) block[table][c * TELEMETRY_BLOCK_ROWS + blockRows[table]] = row[c];
+    if (++blockRows[table] == TELEMETRY_BLOCK_ROWS) writeBlock(table);
+}
+
+void Telemetry::writeBlock(int table) {
+    const size_t n = blockRows[table];
+    if (n == 0) return;
+    blockRows[table] = 0;
+    rows[table] += n;
+    encoded.clear();
+    encoded.push_back((uint8_t)table);
+    put32(encoded, (uint32_t)n);
+    for (const TelemetryColumn& c : telemetrySchema()[table].columns) {
+        const size_t lengthAt = encoded.size();
+        put32(encoded, 0); // patched below
+        const size_t col = (size_t)(&c - telemetrySchema()[table].columns.data());
+        encodeColumn(c.type, block[table].data() + col * TELEMETRY_BLOCK_ROWS, n, encoded);
+        const uint32_t len = (uint32_t)(encoded.size() - lengthAt - 4);
+        for (int i = 0; i < 4; ++i) encoded[lengthAt + i] = (uint8_t)(len >> (8 * i));
+    }
+    if (fwrite(encoded.data(), 1, encoded.size(), file) != encoded.size() && lastError.empty()) lastError = "write failed";
+}
+
+void Telemetry::run() {
+    GenerationRecord g;
+    AgentRecord a;
+    uint64_t row[16];
+    auto lastWrite = chrono::steady_clock::now();
+    for (;;) {
+        const bool stopping = stop.load(memory_order_acquire); // every push happened before this
+        bool any = false;
+        while (generations.pop(g)) {
+            any = true;
+            if (echo) {
+                printf("Gen %d: Best=%.1f, Avg=%.1f, Worst=%.1f, Score=%d, High=%d, Steps=%d (%.3fs)\n",
+                       g.generation, g.best, g.avg, g.worst, g.score, g.highScore, g.steps, g.seconds);
+            }
+            if (!file) continue;
+            row[0] = intBits(g.generation); row[1] = intBits(g.caveSeed);
+            row[2] = floatBits(g.best); row[3] = floatBits(g.avg); row[4] = floatBits(g.worst);
+            row[5] = intBits(g.score); row[6] = intBits(g.highScore); row[7] = intBits(g.steps);
+            row[8] = intBits(g.population); row[9] = floatBits(g.seconds);
+            append(0, row);
+        }
+        while (agents.pop(a)) {
+            any = true;
+            if (!file) continue;
+            row[0] = intBits(a.generation); row[1] = intBits(a.agent); row[2] = intBits(a.caveSeed);
+            row[3] = floatBits(a.fitness); row[4] = floatBits(a.shaping); row[5] = floatBits(a.survival);
+            row[6] = intBits(a.deathScore); row[7] = intBits(a.deathStep);
+            append(1, row);
+        }
+        if (any && echo) fflush(stdout);
+        if (stopping) return;
+        if (!any) {
+            auto now = chrono::steady_clock::now();
+            if (file && now - lastWrite > chrono::seconds(2)) { // slow runs still reach the disk
+                for (int t = 0; t < 2; ++t) writeBlock(t);
+                fflush(file);
+                lastWrite = now;
+            }
+            std::this_thread::sleep_for(chrono::milliseconds(1));
+        }
+    }
+}
+
+// == Reader ==
+bool TelemetryReader::open(const string& path, string& error) {
+    file = fopen(path.c_str(), "rb");
+    if (!file) { error = "cannot open " + path; return false; }
+    uint8_t head[16];
+    if (fread(head, 1, 16, file) != 16 || memcmp(head, MAGIC, 8) != 0) { error = "not a telemetry file"; return false; }
+    auto get32 = [](const uint8_t* p) { uint32_t v = 0; for (int i = 0; i < 4; ++i) v |= (uint32_t)p[i] << (8 * i); return v; };
+    const uint32_t version = get32(head + 8);
+    if (version != TELEMETRY_VERSION) { error = "unsupported version " + to_string(version); return false; }
+    const uint32_t count = get32(head + 12);
+    auto getString = [&](string& s) {
+        int len = fgetc(file);
+        if (len == EOF) return false;
+        s.resize((size_t)len);
+        return len == 0 || fread(&s[0], 1, (size_t)len, file) == (size_t)len;
+    };
+    tables.resize(count);
+    for (TelemetryTable& t : tables) {
+        if (!getString(t.name)) { error = "truncated header"; return false; }
+        const int cols = fgetc(file);
+        if (cols == EOF) { error = "truncated header"; return false; }
+        t.columns.resize((size_t)cols);
+        for (TelemetryColumn& c : t.columns) {
+            const int type = fgetc(file);
+            if (type != (int)ColumnType::Int && type != (int)ColumnType::Float) { error = "bad column type"; return false; }
+            c.type = (ColumnType)type;
+            if (!getString(c.name)) { error = "truncated header"; return false; }
+        }
+    }
+    return true;
+}
+
+bool TelemetryReader::next(string& error) {
+    error.clear();
+    uint8_t head[5];
+    const size_t got = fread(head, 1, 5, file);
+    if (got == 0) return false; // clean end
+    if (got != 5 || head[0] >= tables.size()) { error = "damaged block header"; return false; }
+    table = head[0];
+    rows = (size_t)head[1] | (size_t)head[2] << 8 | (size_t)head[3] << 16 | (size_t)head[4] << 24;
+    if (rows > MAX_BLOCK_ROWS) { error = "damaged block header"; return false; }
+    const vector<TelemetryColumn>& cols = tables[table].columns;
+    columns.resize(cols.size());
+    for (size_t c = 0; c < cols.size(); ++c) {
+        uint8_t len[4];
+        if (fread(len, 1, 4, file) != 4) { error = "truncated block"; return false; }
+        const size_t size = (size_t)len[0] | (size_t)len[1] << 8 | (size_t)len[2] << 16 | (size_t)len[3] << 24;
+        buffer.resize(size);
+        if (size && fread(buffer.data(), 1, size, file) != size) { error = "truncated block"; return false; }
+        columns[c].resize(rows);
+        if (!decodeColumn(cols[c].type, buffer.data(), size, rows, columns[c].data())) {
+            error = "damaged column " + tables[table].name + "." + cols[c].name;
+            return false;
+        }
+    }
+    return true;
+}
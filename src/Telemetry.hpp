@@ -0,0 +1,171 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::vector;
+
+// == Training telemetry ==
+// The training loop pushes fixed-size records into preallocated lock-free
+// rings and never formats or writes anything itself; a background writer
+// drains the rings, echoes the per-generation line and packs the records into
+// a columnar file. Two tables: one row per generation and, optionally, one row
+// per agent and generation (fitness components, death step, cave seed).
+//
+// File layout (version 1, every field little-endian):
+//
+//   header  8  magic "NRRTEL1\0"
+//           4  u32 version
+//           4  u32 table count
+//           per table: u8 name length, name, u8 column count,
+//                      per column: u8 type (0 = int, 1 = float), u8 name length, name
+//   blocks  (until end of file, up to TELEMETRY_BLOCK_ROWS rows of one table each)
+//           1  u8 table index
+//           4  u32 rows
+//           per column: u32 encoded bytes, encoded values
+//
+// Block compression is per column and restarts every block:
+//   int   zigzag varint of the difference to the previous row (generation,
+//         agent index and cave seed cost one byte per row)
+//   float XOR with the previous value's bits; a control byte holds the zero
+//         bytes cut from the top (high nibble) and the bottom (low nibble),
+//         then the remaining middle bytes (a repeated value costs one byte)
+// tools/telemetry_csv turns a file back into CSV.
+
+constexpr uint32_t TELEMETRY_VERSION = 1;
+constexpr size_t TELEMETRY_BLOCK_ROWS = 4096;
+
+// -- Lock-free SPSC ring of trivially copyable records --
+template <class T>
+struct SpscRing {
+    vector<T> slots; // capacity is a power of two
+    size_t mask = 0;
+    alignas(64) std::atomic<uint64_t> head{0}; // next slot to read (consumer only writes)
+    alignas(64) std::atomic<uint64_t> tail{0}; // next slot to write (producer only writes)
+
+    explicit SpscRing(size_t capacity) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        slots.resize(cap);
+        mask = cap - 1;
+    }
+
+    bool push(const T& v) {
+        const uint64_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) > mask) return false; // full
+        slots[t & mask] = v;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& out) {
+        const uint64_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false; // empty
+        out = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+// -- Records (table 0: generations, table 1: agents) --
+struct GenerationRecord {
+    int generation = 0; // generation just evolved
+    uint32_t caveSeed = 0; // cave it flew (first cave with --caves)
+    float best = 0.f, avg = 0.f, worst = 0.f; // fitness over the population
+    int score = 0, highScore = 0; // best flight's score, best score so far
+    int steps = 0; // steps simulated
+    int population = 0; // agents
+    float seconds = 0.f; // wall clock of the generation
+};
+
+// Fitness = shaping + survival + deathScore * 50 (see Simulation::deathFitness);
+// paths that only see the final fitness leave the components NaN and deathStep -1.
+struct AgentRecord {
+    int generation = 0;
+    int agent = 0; // index in the population
+    uint32_t caveSeed = 0;
+    float fitness = 0.f; // final fitness
+    float shaping = 0.f; // accumulated centering / speed shaping (Runners::fitnessAcc)
+    float survival = 0.f; // cave scroll at death
+    int deathScore = 0; // shared score at death
+    int deathStep = -1; // steps flown
+};
+
+enum class ColumnType : uint8_t { Int = 0, Float = 1 };
+
+struct TelemetryColumn {
+    std::string name;
+    ColumnType type = ColumnType::Int;
+};
+
+struct TelemetryTable {
+    std::string name;
+    vector<TelemetryColumn> columns;
+};
+
+// The tables this build writes (index = table id in the file)
+const vector<TelemetryTable>& telemetrySchema();
+
+// Column codecs (values are int64 or float bits, widened to 64 bits)
+void encodeColumn(ColumnType type, const uint64_t* values, size_t n, vector<uint8_t>& out);
+bool decodeColumn(ColumnType type, const uint8_t* data, size_t size, size_t n, uint64_t* values);
+
+// == Background writer ==
+struct Telemetry {
+    SpscRing<GenerationRecord> generations{1024};
+    SpscRing<AgentRecord> agents{1 << 16};
+    bool echo = true; // writer prints the "Gen ..." line of every generation record
+    bool recordAgents = false; // agent rows wanted (producers check this before pushing)
+    uint64_t stalls = 0; // pushes that found a ring full and waited (producer side)
+    uint64_t rows[2] = {0, 0}; // rows written per table (writer side, read after close)
+    uint64_t bytes = 0; // file size after close
+
+    Telemetry() = default;
+    ~Telemetry() { close(); }
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+
+    // Create the file and start the writer; an empty path only echoes. False with error set on failure.
+    bool open(const std::string& path, std::string& error);
+
+    // Producer side (one thread): never drops a record, waits for the writer if a ring is full
+    void generation(const GenerationRecord& r);
+    void agent(const AgentRecord& r);
+
+    void close(); // drain the rings, write the last blocks, stop the writer
+    const std::string& error() const { return lastError; }
+
+private:
+    FILE* file = nullptr;
+    std::thread thread;
+    std::atomic<bool> stop{false};
+    std::string lastError; // first write failure (writer side, read after close)
+    vector<uint64_t> block[2]; // pending rows per table, column-major (column c at c * TELEMETRY_BLOCK_ROWS)
+    size_t blockRows[2] = {0, 0};
+    vector<uint8_t> encoded; // scratch for one column
+
+    void run(); // thread body
+    void append(int table, const uint64_t* row);
+    void writeBlock(int table);
+};
+
+// == Streaming reader ==
+struct TelemetryReader {
+    vector<TelemetryTable> tables; // schema from the file header
+    int table = -1; // table of the current block
+    size_t rows = 0; // rows in the current block
+    vector<vector<uint64_t>> columns; // current block, one vector per column of that table
+
+    ~TelemetryReader() { if (file) fclose(file); }
+
+    bool open(const std::string& path, std::string& error);
+    // Next block; false at end of file (error empty) or on a damaged file (error set)
+    bool next(std::string& error);
+
+private:
+    FILE* file = nullptr;
+    vector<uint8_t> buffer;
+};
@@ -0,0 +1,125 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// == Persistent work-stealing thread pool ==
+// parallelFor splits a range into chunks and deals them round-robin onto one
+// deque per worker. Workers pop their own deque from the back and steal from
+// the front of the others when they run dry. The calling thread takes part
+// as worker 0, so a pool of size 1 runs everything inline. Each chunk runs
+// exactly once. Callers that write disjoint outputs per index therefore get
+// the same results for any thread count.
+struct ThreadPool {
+    struct Job {
+        void (*invoke)(void* ctx, int begin, int end, int worker); // type-erased body
+        void* ctx; // body object
+        std::atomic<int> pending; // chunks not finished yet
+    };
+    struct Chunk { int begin, end; Job* job; };
+    struct Queue { std::mutex m; std::deque<Chunk> chunks; };
+
+    std::vector<std::unique_ptr<Queue>> queues; // one per worker (0 = caller)
+    std::vector<std::thread> threads; // workers 1..n-1
+    std::mutex wakeMutex; // guards epoch/stop for sleeping workers
+    std::condition_variable wake; // signalled when new chunks are queued
+    unsigned epoch = 0; // bumped per parallelFor
+    bool stop = false; // shutting down
+
+    // threads <= 0 uses every hardware thread
+    explicit ThreadPool(int threadCount = 0) {
+        if (threadCount <= 0) threadCount = (int)std::thread::hardware_concurrency();
+        if (threadCount <= 0) threadCount = 1;
+        for (int i = 0; i < threadCount; ++i) queues.emplace_back(new Queue());
+        for (int i = 1; i < threadCount; ++i) threads.emplace_back([this, i] { workerLoop(i); });
+    }
+
+    ~ThreadPool() {
+        { std::lock_guard<std::mutex> lock(wakeMutex); stop = true; }
+        wake.notify_all();
+        for (std::thread& t : threads) t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return (int)queues.size(); }
+
+    // -- Run fn(begin, end, worker) over [0, n) in chunks of at most grain --
+    template <class F>
+    void parallelFor(int n, int grain, F&& fn) {
+        if (n <= 0) return;
+        if (grain < 1) grain = 1;
+        if (queues.size() == 1 || n <= grain) { fn(0, n, 0); return; } // not worth waking anyone
+
+        Job job;
+        using Body = typename std::remove_reference<F>::type;
+        job.invoke = [](void* ctx, int b, int e, int w) { (*static_cast<Body*>(ctx))(b, e, w); };
+        job.ctx = (void*)&fn;
+        const int chunks = (n + grain - 1) / grain;
+        job.pending.store(chunks, std::memory_order_relaxed);
+
+        for (int c = 0; c < chunks; ++c) { // deal chunks round-robin
+            Queue& q = *queues[c % queues.size()];
+            std::lock_guard<std::mutex> lock(q.m);
+            q.chunks.push_back(Chunk{c * grain, std::min(n, (c + 1) * grain), &job});
+        }
+        { std::lock_guard<std::mutex> lock(wakeMutex); ++epoch; }
+        wake.notify_all();
+
+        drain(0); // the caller works too
+        while (job.pending.load(std::memory_order_acquire) > 0) { // stragglers on other workers
+            if (!drain(0)) std::this_thread::yield();
+        }
+    }
+
+    // -- Execute chunks until none are left anywhere, returns true if any ran --
+    bool drain(int self) {
+        bool ran = false;
+        Chunk c;
+        while (popOwn(self, c) || steal(self, c)) {
+            c.job->invoke(c.job->ctx, c.begin, c.end, self);
+            c.job->pending.fetch_sub(1, std::memory_order_release);
+            ran = true;
+        }
+        return ran;
+    }
+
+    bool popOwn(int self, Chunk& out) {
+        Queue& q = *queues[self];
+        std::lock_guard<std::mutex> lock(q.m);
+        if (q.chunks.empty()) return false;
+        out = q.chunks.back(); q.chunks.pop_back(); // LIFO: warm in cache
+        return true;
+    }
+
+    bool steal(int self, Chunk& out) {
+        const int n = (int)queues.size();
+        for (int k = 1; k < n; ++k) {
+            Queue& q = *queues[(self + k) % n];
+            std::lock_guard<std::mutex> lock(q.m);
+            if (q.chunks.empty()) continue;
+            out = q.chunks.front(); q.chunks.pop_front(); // FIFO: oldest, largest remaining work
+            return true;
+        }
+        return false;
+    }
+
+    void workerLoop(int self) {
+        unsigned seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                wake.wait(lock, [&] { return stop || epoch != seen; });
+                if (stop) return;
+                seen = epoch;
+            }
+            drain(self);
+        }
+    }
+};
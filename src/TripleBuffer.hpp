@@ -0,0 +1,30 @@
+#pragma once
+#include <atomic>
+
+// == Lock-free single-producer / single-consumer triple buffer ==
+// The writer always owns one slot and the reader another; the third slot sits
+// in the middle. publish() swaps the writer's slot into the middle and marks
+// it fresh, update() swaps a fresh middle slot out to the reader. Neither side
+// ever blocks, and the reader always sees a complete, consistent T.
+template <class T>
+struct TripleBuffer {
+    static constexpr int INDEX = 3; // slot index bits
+    static constexpr int FRESH = 4; // middle slot holds unread data
+
+    T slots[3];
+    std::atomic<int> middle{1}; // middle slot index | FRESH
+    int back = 0; // writer's slot
+    int front = 2; // reader's slot
+
+    // -- Writer side --
+    T& writeSlot() { return slots[back]; }
+    void publish() { back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX; }
+
+    // -- Reader side: grab the newest published slot, returns false if none is new --
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+    const T& readSlot() const { return slots[front]; }
+};
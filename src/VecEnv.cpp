@@ -0,0 +1,95 @@
+#include "VecEnv.hpp"
+#include <algorithm>
+
+using namespace std;
+
+VecEnv::VecEnv(int n, ThreadPool* workers) : pool(workers) {
+    for (int r = 0; r < NUM_RAYS; ++r) rayAngles[r] = rayAngle(r);
+    caves.resize(n);
+    y.assign(n, 0.f); vy.assign(n, 0.f); fitnessAcc.assign(n, 0.f);
+    offset.assign(n, 0.f); wallTop.assign(n, 0.f); wallBot.assign(n, 0.f);
+    pxAcc.assign(n, 0.f); value.assign(n, 0.f); scrollBefore.assign(n, 0.f);
+    score.assign(n, 0); steps.assign(n, 0);
+    seeds.assign(n, 0u); episode.assign(n, 0u);
+    episodeReturn.assign(n, 0.f); episodeScroll.assign(n, 0.f); episodeScore.assign(n, 0); episodeSteps.assign(n, 0);
+}
+
+void VecEnv::reset(const uint32_t* envSeeds, float* observations) {
+    span = std::max((float)W, x + RAY_MAX) + 1.f;
+    parallelFor(size(), [&](int begin, int end, int) {
+        for (int i = begin; i < end; ++i) {
+            seeds[i] = envSeeds[i];
+            episode[i] = 0;
+            beginEpisode(i, envSeeds[i], observations + (size_t)i * OBS_SIZE);
+        }
+    });
+}
+
+void VecEnv::step(const float* actions, float* observations, float* rewards, uint8_t* dones) {
+    PROFILE_SCOPE("vecenv/step");
+    parallelFor(size(), [&](int begin, int end, int) {
+        for (int i = begin; i < end; ++i) stepOne(i, actions[i], observations + (size_t)i * OBS_SIZE, rewards + i, dones + i);
+    });
+}
+
+// -- New layout, runner centred on the corridor (walls sampled exactly, as resetGeneration does) --
+void VecEnv::beginEpisode(int i, uint32_t caveSeed, float* obs) {
+    CaveColumns columns = std::move(caves[i].columns); // keep the cache's buffers
+    caves[i] = Cave(caveSeed);
+    float t, b; caves[i].sample(W, H, x, t, b);
+    y[i] = 0.5f * (t + b); vy[i] = 0.f; fitnessAcc[i] = 0.f;
+    pxAcc[i] = 0.f; value[i] = 0.f;
+    score[i] = 0; steps[i] = 0;
+    ++episode[i];
+    if (cacheColumns) {
+        columns.count = 0; // stale columns belong to the last layout
+        caves[i].columns = std::move(columns);
+        caves[i].enableCache(0.f, span);
+    }
+    observe(i, obs);
+}
+
+// -- The start of a Simulation step for one runner: scroll, walls, rays --
+void VecEnv::observe(int i, float* obs) {
+    Cave& cave = caves[i];
+    scrollBefore[i] = cave.scroll;
+    cave.update(VX, dt);
+    float senseTop, senseBot;
+    cave.sample(W, H, x + 30.f, senseTop, senseBot); // slightly ahead
+    cave.sample(W, H, x, wallTop[i], wallBot[i]);
+    float rayDists[NUM_RAYS];
+    for (int r = 0; r < NUM_RAYS; ++r) rayDists[r] = castRay(cave, W, H, x, y[i], rayAngles[r], RAY_MAX, RAY_STEP);
+    offset[i] = encodeObservation(rayDists, y[i], vy[i], senseTop, senseBot, obs);
+}
+
+void VecEnv::stepOne(int i, float action, float* obs, float* reward, uint8_t* done) {
+    const float a = std::max(-1.f, std::min(1.f, action));
+    const float y0 = y[i];
+    bool crashed = moveRunner(a, false, offset[i], dt, H, wallTop[i], wallBot[i], y[i], vy[i], fitnessAcc[i]);
+    float deathScroll = caves[i].scroll, contact;
+    int points = score[i];
+    if (sweptCollision && caves[i].sweep(H, x, scrollBefore[i], caves[i].scroll, y0, y[i], contact)) {
+        crashed = true;
+        deathScroll = scrollBefore[i] + contact * (caves[i].scroll - scrollBefore[i]);
+        points += (int)((pxAcc[i] + (deathScroll - scrollBefore[i])) / PIXELS_PER_POINT); // points of the part flown
+    }
+    ++steps[i];
+    if (!crashed) { // the score counts the steps survived
+        pxAcc[i] += VX * dt;
+        while (pxAcc[i] >= PIXELS_PER_POINT) { score[i] += 1; pxAcc[i] -= PIXELS_PER_POINT; }
+        points = score[i];
+    }
+    const float fitness = fitnessAcc[i] + deathScroll + (float)points * 50.f; // Simulation::deathFitness
+    *reward = fitness - value[i];
+    value[i] = fitness;
+    *done = crashed ? Crashed : steps[i] >= maxSteps ? TimeLimit : Running;
+    if (*done == Running) {
+        observe(i, obs);
+        return;
+    }
+    episodeReturn[i] = fitness;
+    episodeScroll[i] = deathScroll;
+    episodeScore[i] = points;
+    episodeSteps[i] = steps[i];
+    beginEpisode(i, caveSeed(seeds[i], episode[i]), obs);
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Sim.hpp"
+
+using std::vector;
+
+// == Batched cave environments for external trainers ==
+// N independent single-runner episodes, each in its own seeded cave, stepped
+// together. Observations, rewards and done flags are written straight into
+// caller-owned contiguous buffers, so a policy can run on its own batch
+// layout without any copy in between:
+//
+//   VecEnv env(4096, &pool);
+//   env.reset(seeds, obs);                    // obs: N x VecEnv::OBS_SIZE floats
+//   for (;;) {
+//       policy(obs, actions);                 // actions: N floats in [-1, 1]
+//       env.step(actions, obs, rewards, dones);
+//   }
+//
+// Observation, control, shaping and collision are the Simulation's own
+// (encodeObservation, moveRunner, castRay with the column cache), so the
+// built-in network flies the same episode here as in training with
+// --ray-tolerance -1. The reward of a step is the change of the runner's
+// fitness (shaping + cave scroll + 50 x score); an episode's rewards add up to
+// the fitness evolve would see.
+//
+// A finished environment resets itself within the same step: its done flag is
+// set, the observation is already the first of the next episode (cave
+// caveSeed(seed, episode)), and the finished episode's totals are kept in
+// episodeReturn / episodeScroll / episodeScore / episodeSteps until the next
+// one ends.
+
+struct VecEnv {
+    static constexpr int OBS_SIZE = NUM_INPUTS; // floats per observation
+    enum Done : uint8_t { Running = 0, Crashed = 1, TimeLimit = 2 };
+
+    int W = 800, H = 600; // world size
+    float x = 240.f; // runner X
+    float dt = 1.f / 60.f; // fixed timestep
+    int maxSteps = 36000; // steps before an episode is cut off (done = TimeLimit)
+    bool cacheColumns = true; // cave column cache (as the Simulation; false = exact walls)
+    bool sweptCollision = false; // swept wall test between steps (as Simulation::sweptCollision)
+    ThreadPool* pool = nullptr; // optional workers (not owned)
+
+    // Per-environment state
+    vector<Cave> caves;
+    vector<float> y, vy, fitnessAcc; // runner
+    vector<float> offset; // corridor offset of the last observation (fitness shaping)
+    vector<float> wallTop, wallBot; // walls at the runner's x for the next step
+    vector<float> pxAcc, value; // score accumulator, fitness paid out as reward so far
+    vector<float> scrollBefore; // cave scroll before the last observe's update
+    vector<int> score, steps;
+    vector<uint32_t> seeds; // base seed per environment
+    vector<uint32_t> episode; // episodes started per environment
+
+    // Last finished episode per environment
+    vector<float> episodeReturn;
+    vector<float> episodeScroll; // survival distance (scroll at the contact with swept collision)
+    vector<int> episodeScore, episodeSteps;
+
+    explicit VecEnv(int n, ThreadPool* workers = nullptr);
+
+    int size() const { return (int)y.size(); }
+
+    // Start episode 0 of every environment in Cave(seeds[i]); writes the first observations
+    void reset(const uint32_t* envSeeds, float* observations);
+
+    // Apply actions[i] (tanh range; clamped) to every environment, write the next observations,
+    // the step rewards and the done flags (Done values)
+    void step(const float* actions, float* observations, float* rewards, uint8_t* dones);
+
+private:
+    float rayAngles[NUM_RAYS];
+    float span = 0.f; // screen X covered by the column cache
+
+    void beginEpisode(int i, uint32_t caveSeed, float* obs);
+    void observe(int i, float* obs); // advance the cave one step and sense
+    void stepOne(int i, float action, float* obs, float* reward, uint8_t* done);
+
+    template <class F>
+    void parallelFor(int n, F&& body) {
+        if (pool) pool->parallelFor(n, 64, body);
+        else if (n > 0) body(0, n, 0);
+    }
+};
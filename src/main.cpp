@@ -9,87 +9,23 @@
 #include "Cave.hpp"
 #include "NeuralNet.hpp"
 #include "Agent.hpp"
+#include "Sim.hpp"
+#include "Headless.hpp"
+#include "SimThread.hpp"
+#include "Renderer.hpp"
+#include "Profiler.hpp"
 
 using namespace std;
 
-// == Constants ==
-static constexpr int   NUM_RAYS = 7; // number of rays cast for sensing
-static constexpr float RAY_FOV  = 1.2f; // total FOV in radians
-static constexpr float RAY_MAX  = 700.f; // max ray distance
-static constexpr float RAY_STEP = 4.f; // ray marching step size
-
-static const int   POP_SIZE    = 50; // population size
-static const int   ELITE_COUNT = 5; // number of elite agents preserved each generation
-static const float MUT_PROB    = 0.15f; // mutation probability
-static const float MUT_SIGMA   = 0.30f; // mutation strength
-
-static const float VX = 220.f;  // horizontal scroll speed (px/s)
-static const float VY = 200.f;  // max vertical speed (px/s)
-
-static const float PIXELS_PER_POINT = 50.f; // scoring resolution
-static const float ARROW_SIZE       = 20.f; // size of the agent arrow
-
-// == Drawing helpers ==
-static void drawText(SDL_Renderer* renderer, TTF_Font* font, const char* text, int x, int y) {
-    SDL_Color color = {255, 255, 255, 255}; // white color
-    SDL_Surface* surface = TTF_RenderText_Blended(font, text, color); // create surface
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface); // create texture
-    SDL_Rect dest = {x, y, surface->w, surface->h}; // destination rectangle
-    SDL_FreeSurface(surface); // free the surface
-    SDL_RenderCopy(renderer, texture, nullptr, &dest); // render the texture
-    SDL_DestroyTexture(texture); // destroy the texture
-}
-
-static void drawArrow(SDL_Renderer* renderer, float x, float y, float angle, float size) {
-    float half = size * 0.5f; // half size
-
-    SDL_FPoint p1 = {x + size, y}; // tip point
-    SDL_FPoint p2 = {x - half, y - half}; // bottom rear point
-    SDL_FPoint p3 = {x - half, y + half}; // top rear point
-
-    auto rot = [&](SDL_FPoint p) {
-        float s = sinf(angle), c = cosf(angle); // sine and cosine of angle
-        float px = p.x - x, py = p.y - y; // translate to origin
-        return SDL_FPoint{px * c - py * s + x, px * s + py * c + y}; // rotate and translate back
-    };
-    p1 = rot(p1); p2 = rot(p2); p3 = rot(p3); // rotate all points
-
-    Uint8 r,g,b,a; SDL_GetRenderDrawColor(renderer,&r,&g,&b,&a); // get current color
-    SDL_Color col = {r,g,b,a}; // create SDL_Color
-
-    SDL_Vertex vtx[3]; // define vertices
-    vtx[0].position = p1; vtx[0].color = col; // tip
-    vtx[1].position = p2; vtx[1].color = col; // bottom rear
-    vtx[2].position = p3; vtx[2].color = col; // top rear
-
-    SDL_RenderGeometry(renderer, nullptr, vtx, 3, nullptr, 0); // render triangle, fill with color instead of hollow triangle
-}
-
-// == Ray casting function ==
-static float castRay(const Cave& cave, int W, int H, float ox, float oy,
-                     float angle, float maxDist = RAY_MAX, float step = RAY_STEP) {
-    float dx = cosf(angle) * step; // delta x per step
-    float dy = sinf(angle) * step; // delta y per step
-    float x = ox, y = oy, dist = 0.f; // initialize position and distance
-    while (dist < maxDist) { // while within max distance
-        float topY, botY; // cave boundaries
-        cave.sample(W, H, x, topY, botY); // sample cave at current x
-        if (y < topY || y > botY) break; // collision detected
-        x += dx; y += dy; dist += step; // advance ray
+// == Main function ==
+int main(int argc, char** argv) {
+    // -- Headless training (no window, renderer or font) --
+    if (wantsHeadless(argc, argv)) {
+        HeadlessOptions opt;
+        if (!parseHeadlessArgs(argc, argv, opt)) return 2;
+        return runHeadless(opt);
     }
-    return dist; // return distance traveled
-}
 
-//  == Runner structure ==
-struct Runner {
-    float y = 0.f; // vertical position
-    float vy = 0.f; // vertical velocity
-    bool  alive = true; // alive status
-    float fitness_acc = 0.f; // accumulated fitness
-};
-
-// == Main function ==
-int main() {
     // -- SDL & TTF init ---
     SDL_Init(SDL_INIT_VIDEO); // initialize SDL
     TTF_Init(); // initialize TTF
@@ -101,214 +37,132 @@ int main() {
     SDL_Renderer* renderer = SDL_CreateRenderer( // create renderer
         window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC); // with vsync
 
-    // -- Timing --
-    Uint64 prev = SDL_GetPerformanceCounter(); // previous timestamp
-    const double freq = (double)SDL_GetPerformanceFrequency(); // performance frequency
-
     // -- World & UI state --
     int   W = 800, H = 600; // window size
-    float x = 240.f; // fixed X for all agents
-    int   score = 0, highScore = 0; // current and high score
-    float pxAcc = 0.f; // pixel accumulator for scoring
-
-    // -- Population & agents --
-    std::mt19937 rng(std::random_device{}()); // random number generator
-    vector<Agent> agents; agents.reserve(POP_SIZE); // agent population
-    for (int i = 0; i < POP_SIZE; ++i) { // for each agent
-        agents.emplace_back(NUM_RAYS + 2); // create agents
-    }
-    vector<Runner> runners(agents.size()); // corresponding runners
-
-    // -- Cave per generation --
-    int   generation = 1; // generation counter
-    float bestFitnessEver = 0.f; // best fitness ever
-    Cave  cave, baseCave; // cave instances
-
-    // -- Helper lambdas --
-    auto center_on_corridor = [&](float& yOut){ // center y on cave corridor
-        float t,b; cave.sample(W,H,x,t,b); // sample cave
-        yOut = 0.5f * (t + b); // set y to center
-    };
+    Renderer draw(renderer, font); // batched geometry & cached HUD textures
 
-    // -- Reset the entire generation --
-    auto reset_generation = [&](){
-        // If you can seed Cave deterministically, do it here for reproducibility
-        baseCave = Cave(); // create new base cave
-        cave = baseCave; // assign to current cave
-
-        for (size_t i = 0; i < runners.size(); ++i) { // for each runner
-            runners[i] = Runner{}; // reset runner
-            runners[i].alive = true; // set alive
-            runners[i].vy = 0.f; // reset vertical velocity
-            float t,b; cave.sample(W,H,x,t,b); // sample cave
-            runners[i].y = 0.5f*(t+b); // center on corridor
-            agents[i].fitness = 0.f; // reset fitness
-        }
-
-        score = 0; pxAcc = 0.f; // reset score
-    };
-
-    reset_generation(); // initial generation reset
+    // -- Simulation on its own thread (fixed timestep) --
+    ThreadPool pool; // per-agent phases on every core
+    SimThread simThread(POP_SIZE, &pool); // population, cave and evolution
+    simThread.start();
+    static const int SPEEDS[] = {1, 10, 100, 0}; // keys 1..4 (0 = max)
+    bool showProfile = false; // P toggles the phase timing overlay
+    vector<PhaseStat> phases; // overlay rows (refreshed a few times a second)
+    double phasesAt = 0.0; // wall clock of the last refresh
 
     // -- Main loop --
     bool running = true; // running flag
     while (running) { // main loop
+        PROFILE_SCOPE("frame");
         // Events
-        SDL_Event e; // event variable
-        while (SDL_PollEvent(&e)) { // poll events
-            if (e.type == SDL_QUIT || // quit event
-               (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE)) { // escape key
-                running = false; // stop running
+        {
+            PROFILE_SCOPE("frame/events");
+            SDL_Event e; // event variable
+            while (SDL_PollEvent(&e)) { // poll events
+                if (e.type == SDL_QUIT || // quit event
+                   (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE)) { // escape key
+                    running = false; // stop running
+                }
+                if (e.type == SDL_KEYDOWN && e.key.keysym.sym >= SDLK_1 && e.key.keysym.sym <= SDLK_4) {
+                    simThread.speed = SPEEDS[e.key.keysym.sym - SDLK_1]; // time acceleration
+                }
+                if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_p) showProfile = !showProfile; // overlay
             }
         }
 
         // Window size (handle resizes)
         SDL_GetWindowSize(window, &W, &H); // get window size
+        simThread.viewW = W; simThread.viewH = H;
 
-        // Delta time (cap)
-        Uint64 now = SDL_GetPerformanceCounter(); // current timestamp
-        float dt = float(now - prev) / float(freq); // delta time in seconds
-        if (dt > 0.033f) dt = 0.033f; // cap dt to ~30 FPS
-        prev = now; // update previous timestamp
+        // Manual override (SPACE makes you go up at max speed)
+        const Uint8* ks = SDL_GetKeyboardState(nullptr); // keyboard state
+        simThread.manual = ks[SDL_SCANCODE_SPACE] != 0; // space key for manual control
 
-        // Keep x’s corridor valid (on the very first frames / resizes)
-        float topY0, botY0; // cave boundaries at agent x
-        cave.sample(W, H, x, topY0, botY0); // sample cave
+        // Latest consistent simulation state
+        simThread.snapshots.update();
+        const Snapshot& snap = simThread.snapshots.readSlot();
 
-        // Update cave scroll once per frame
-        cave.update(VX, dt); // update cave scroll
+        // Interpolate between the last two steps
+        float alpha = 1.f; // 0 = previous step, 1 = latest step
+        if (snap.speed > 0) {
+            double ahead = (SimThread::clockSeconds() - snap.publishedAt) * snap.speed / snap.dt;
+            alpha = std::min(1.f, snap.alpha0 + (float)ahead);
+        }
+        Cave cave = snap.cave; // cave to draw
+        cave.scroll = snap.prevScroll + (snap.cave.scroll - snap.prevScroll) * alpha;
+        const float x = snap.x; // fixed X for all agents
+        auto lerpY = [&](size_t i) { return snap.prevY[i] + (snap.y[i] - snap.prevY[i]) * alpha; };
 
         // Background
         SDL_SetRenderDrawColor(renderer, 17, 17, 17, 255); // dark background
         SDL_RenderClear(renderer); // clear screen
 
-        // Draw cave walls
-        SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255); // green walls
-        for (int xp = 0; xp < W; ++xp) { // for each x pixel
-            float t,b; cave.sample(W,H,(float)xp,t,b); // sample cave
-            SDL_RenderDrawLineF(renderer, (float)xp, 0.f, (float)xp, t); // top wall
-            SDL_RenderDrawLineF(renderer, (float)xp, b, (float)xp, (float)H); // bottom wall
+        // Cave walls, then agents, then the best-alive highlight (one submission)
+        draw.begin();
+        {
+            PROFILE_SCOPE("frame/walls");
+            draw.addWalls(cave, W, H, SDL_Color{0, 255, 0, 255}); // green walls
         }
 
-        // Manual override (SPACE makes you go up at max speed)
-        const Uint8* ks = SDL_GetKeyboardState(nullptr); // keyboard state
-        bool manual = ks[SDL_SCANCODE_SPACE]; // space key for manual control
-
-        // Simulate all agents
-        bool anyAlive = false; // any alive flag
-        int  bestAliveIdx = -1; float bestAliveFit = -1e9f; // best alive tracking
-
-        for (size_t i = 0; i < agents.size(); ++i) { // for each agent
-            Runner& R = runners[i]; // corresponding runner
-            if (!R.alive) continue; // skip if dead
-            anyAlive = true; // at least one alive
-
-            // -- Sensing (forward-locked FOV for stability) --
-            float rayAngles[NUM_RAYS], rayDists[NUM_RAYS]; // ray data
-            const float angleForward = 0.0f; // straight ahead (world +X)
-            for (int r = 0; r < NUM_RAYS; ++r) { // for each ray
-                float t = (NUM_RAYS == 1) ? 0.5f : (float)r / (float)(NUM_RAYS - 1); // normalized [0,1]
-                float a = angleForward - (RAY_FOV * 0.5f) + t * RAY_FOV; // ray angle
-                rayAngles[r] = a; // store angle
-                rayDists[r]  = castRay(cave, W, H, x, R.y, a, RAY_MAX, RAY_STEP); // cast ray
+        auto heading = [&](size_t i, float& c, float& s) { // unit vector along the velocity
+            float len = sqrtf(VX * VX + snap.vy[i] * snap.vy[i]);
+            c = VX / len; s = -snap.vy[i] / len;
+        };
+        {
+            PROFILE_SCOPE("frame/agents");
+            for (size_t i = 0; i < snap.y.size(); ++i) { // for each runner
+                if (!snap.alive[i]) continue; // skip dead agents
+                float c, s; heading(i, c, s); // visual direction
+                draw.addArrow(x, lerpY(i), c, s, ARROW_SIZE * 0.9f, SDL_Color{173, 26, 255, 120}); // purple
             }
-
-            // -- Neural Network Decision --
-            float topSense, botSense; // cave boundaries for sensing
-            cave.sample(W, H, x + 30.f, topSense, botSense); // sample slightly ahead
-            float center = 0.5f*(topSense + botSense); // cave center
-            float halfGap = 0.5f*(botSense - topSense); // half gap size
-            float offSetNorm = (halfGap > 1.f) ? (R.y - center)/halfGap : 0.f; // normalized offset
-            float velNorm = std::max(-1.f, std::min(1.f, R.vy / VY)); // normalized velocity
-
-            vector<float> in; in.reserve(NUM_RAYS + 2); // NN input vector
-            for (int r = 0; r < NUM_RAYS; ++r){ // for each ray
-                in.push_back(std::min(1.f, rayDists[r]/RAY_MAX)); // normalized distance
+            if (snap.bestAliveIdx >= 0 && snap.bestAliveIdx < (int)snap.y.size()) {
+                size_t i = (size_t)snap.bestAliveIdx; // best runner
+                float c, s; heading(i, c, s); // visual direction
+                draw.addArrow(x, lerpY(i), c, s, ARROW_SIZE, SDL_Color{255, 255, 255, 255}); // white
             }
-            in.push_back(offSetNorm); // normalized offset
-            in.push_back(velNorm); // normalized velocity
-
-            float a = agents[i].brain.forward(in); // tanh ∈ [-1,1]
-
-            // -- Control (proportional velocity) --
-            if (manual) {
-                R.vy = VY; // max upward speed
-            }
-            else { 
-                R.vy = a * VY; // set vertical speed
-            }
-            R.y -= R.vy * dt; // update vertical position
-            if (R.y < ARROW_SIZE) {
-                R.y = ARROW_SIZE; // top boundary
-            }
-            if (R.y > H - ARROW_SIZE) {
-                R.y = H - ARROW_SIZE; // bottom boundary
-            }
-
-            // -- Fitness shaping (gentle) --
-            R.fitness_acc += dt * (1.0f - 0.1f * fabsf(offSetNorm) - 0.001f * a * a); // reward center and smoothness
-
-            // -- Collision --
-            float t0, b0; cave.sample(W, H, x, t0, b0); // sample cave at agent x
-            if (R.y < t0 || R.y > b0) { // collision check
-                R.alive = false; // mark as dead
-                float survivalBonus = cave.scroll; // survival bonus based on distance
-                agents[i].fitness = R.fitness_acc + survivalBonus + (float)score * 50.f; // total fitness
-            }
-
-            // Track best alive (for highlight)
-            if (R.alive && agents[i].fitness > bestAliveFit) { // better than current best
-                bestAliveFit = agents[i].fitness; // update best fitness
-                bestAliveIdx = (int)i; // update best index
-            }
-
-            // Render this agent (dim)
-            SDL_SetRenderDrawColor(renderer, 173, 26, 255, R.alive ? 120 : 40); // purple, dim if dead
-            float visAngle = atan2f(-R.vy, VX); // visual angle based on velocity
-            drawArrow(renderer, x, R.y, visAngle, ARROW_SIZE * 0.9f); // draw agent
-
-        }
-
-        // Highlight current best-alive (if any)
-        if (bestAliveIdx >= 0) {
-            Runner& R = runners[bestAliveIdx]; // best runner
-            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255); // white color
-            float visAngle = atan2f(-R.vy, VX); // visual angle
-            drawArrow(renderer, x, R.y, visAngle, ARROW_SIZE); // draw highlighted agent
         }
-
-        // Score (distance-based, shared)
-        if (anyAlive) { // if at least one alive
-            pxAcc += VX * dt; // accumulate pixels
-            while (pxAcc >= PIXELS_PER_POINT) { score += 1; pxAcc -= PIXELS_PER_POINT; } // update score
+        {
+            PROFILE_SCOPE("frame/submit");
+            draw.flush();
         }
 
-        // If everyone died -> evolve & new generation
-        if (!anyAlive) {
-            if (score > highScore) highScore = score; // update high score
-
-            // Evolve population
-            evolve(agents, rng, ELITE_COUNT, MUT_SIGMA, MUT_PROB, generation, bestFitnessEver); // evolve agents
-
-            // Reset world & runners for the new generation
-            reset_generation();
+        // HUD (textures are rebuilt only when a line changes)
+        PROFILE_SCOPE("frame/hud");
+        char line[128];
+        snprintf(line, sizeof(line), "Gen: %d", snap.generation);
+        draw.text(0, line, 16, 16);
+        snprintf(line, sizeof(line), "Score: %d   High: %d", snap.score, snap.highScore);
+        draw.text(1, line, 16, 42);
+        snprintf(line, sizeof(line), "Pop: %d  Elite: %d", snap.population, ELITE_COUNT);
+        draw.text(2, line, 16, 68);
+        if (snap.speed > 0) snprintf(line, sizeof(line), "Speed: %dx  (%.0f steps/s)", snap.speed, snap.stepsPerSec);
+        else snprintf(line, sizeof(line), "Speed: max  (%.0f steps/s)", snap.stepsPerSec);
+        draw.text(3, line, 16, 94);
+
+        // Profiler overlay: rolling p50 / p99 per phase over the last 2 s
+        if (showProfile) {
+            double now = SimThread::clockSeconds();
+            if (now - phasesAt > 0.25) { Profiler::instance().phaseStats(2000.0, phases); phasesAt = now; }
+            int row = 4, y = 132; // HUD slot and position of the first row
+            if (!PROFILING_ENABLED) {
+                draw.text(row, "Profiling off (build with -DNRR_PROFILE)", 16, y);
+            }
+            for (const PhaseStat& p : phases) {
+                snprintf(line, sizeof(line), "%-16s p50 %7.3f ms  p99 %7.3f ms", p.name, p.p50Ms, p.p99Ms);
+                draw.text(row++, line, 16, y); y += 22;
+            }
         }
 
-        // HUD
-        char line1[128], line2[128], line3[128];
-        snprintf(line1, sizeof(line1), "Gen: %d", generation);
-        snprintf(line2, sizeof(line2), "Score: %d   High: %d", score, highScore);
-        snprintf(line3, sizeof(line3), "Pop: %zu  Elite: %d", agents.size(), ELITE_COUNT);
-
-        drawText(renderer, font, line1, 16, 16);
-        drawText(renderer, font, line2, 16, 42);
-        drawText(renderer, font, line3, 16, 68);
+        SDL_RenderPresent(renderer); // paced by vsync only
+    }
 
-        SDL_RenderPresent(renderer);
-        SDL_Delay(16); // ~60 FPS
+    simThread.stop(); // join before tearing down SDL
+    if (PROFILING_ENABLED) { // keep the last few seconds for chrome://tracing
+        if (Profiler::instance().dumpChromeTrace("nrr_trace.json")) SDL_Log("Wrote nrr_trace.json");
     }
 
     // Cleanup
+    draw.releaseText();
     TTF_CloseFont(font);
     TTF_Quit();
     SDL_DestroyRenderer(renderer);
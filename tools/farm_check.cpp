@@ -0,0 +1,102 @@
+// Evaluation farm check: a local stand-in coordinator with forked workers.
+//
+// usage: farm_check [--workers N] [--population N] [--generations G] [--seed S]
+//                   [--max-steps N] [--batch N] [--socket PATH]
+//
+// Starts a coordinator on PATH and forks N worker processes connected to it.
+// The first worker crashes on its second batch, so its unanswered batches must
+// be resubmitted to the others. Every generation is flown on the farm and again
+// in this process on the same cave, and the fitness vectors have to match bit
+// for bit; the population evolves as seed chains on the farm's fitness.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Farm.hpp"
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    int workers = 3, population = 200, generations = 3, maxSteps = 3600, batch = 16;
+    unsigned seed = 1;
+    string path = "/tmp/nrr_farm_check.sock";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--workers") == 0) workers = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--population") == 0) population = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--generations") == 0) generations = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--seed") == 0) seed = (unsigned)strtoul(argv[i + 1], nullptr, 10);
+        else if (strcmp(argv[i], "--max-steps") == 0) maxSteps = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--batch") == 0) batch = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--socket") == 0) path = argv[i + 1];
+    }
+    if (workers < 2 || population < 2 * ELITE_COUNT || generations <= 0 || maxSteps <= 0 || batch <= 0) {
+        fprintf(stderr, "usage: %s [--workers N>=2] [--population N] [--generations G] [--seed S]"
+                        " [--max-steps N] [--batch N] [--socket PATH]\n", argv[0]);
+        return 2;
+    }
+
+    FarmCoordinator farm;
+    farm.batchSize = batch;
+    string error;
+    if (!farm.listen(path, error)) { fprintf(stderr, "%s\n", error.c_str()); return 1; }
+    vector<pid_t> children;
+    for (int w = 0; w < workers; ++w) {
+        pid_t pid = fork();
+        if (pid == 0) _exit(runFarmWorker(path, w == 0 ? 2 : 0)); // worker 0 dies on its second batch
+        if (pid < 0) { perror("fork"); return 1; }
+        children.push_back(pid);
+    }
+    if (!farm.waitForWorkers(workers, error)) { fprintf(stderr, "%s\n", error.c_str()); return 1; }
+
+    mt19937 rng(seed);
+    vector<SeedGenome> genomes, next;
+    for (int i = 0; i < population; ++i) genomes.emplace_back((uint32_t)rng());
+    EvolveBuffers buf;
+    FarmEvaluator local;
+    int generation = 1;
+    float bestFitness = 0.f;
+    long long mismatches = 0;
+    double farmSecs = 0.0, localSecs = 0.0;
+
+    for (int g = 0; g < generations; ++g) {
+        FarmParams p;
+        p.caveSeed = caveSeed(seed, (uint64_t)generation);
+        p.maxSteps = maxSteps;
+        vector<float> remote, reference;
+        int score = 0, steps = 0, localScore = 0, localSteps = 0;
+
+        auto t0 = chrono::steady_clock::now();
+        if (!farm.evaluate(genomes, p, remote, score, steps, error)) { fprintf(stderr, "%s\n", error.c_str()); return 1; }
+        auto t1 = chrono::steady_clock::now();
+        local.evaluate(genomes, p, reference, localScore, localSteps);
+        auto t2 = chrono::steady_clock::now();
+        farmSecs += chrono::duration<double>(t1 - t0).count();
+        localSecs += chrono::duration<double>(t2 - t1).count();
+
+        int bad = 0;
+        for (int i = 0; i < population; ++i) bad += remote[i] != reference[i];
+        bad += score != localScore || steps != localSteps;
+        mismatches += bad;
+        printf("gen %d: %d mismatches, score %d, steps %d, %d workers connected\n",
+               generation, bad, score, steps, farm.readyWorkers());
+
+        evolveChains(genomes, next, remote, buf, rng, seed, ELITE_COUNT, MUT_SIGMA, MUT_PROB, generation, bestFitness);
+    }
+
+    printf("batches %llu, resubmitted %llu, workers lost %llu\n", (unsigned long long)farm.batchesSent,
+           (unsigned long long)farm.resubmitted, (unsigned long long)farm.workersLost);
+    printf("farm %.2fs, in process %.2fs\n", farmSecs, localSecs);
+    farm.shutdown();
+    for (pid_t pid : children) waitpid(pid, nullptr, 0);
+
+    const bool ok = mismatches == 0 && farm.resubmitted > 0;
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
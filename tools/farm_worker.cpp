@@ -0,0 +1,21 @@
+// Evaluation farm worker: connects to a training run's farm socket and flies
+// the batches of genomes it is sent until the run ends (see src/Farm.hpp).
+//
+// usage: farm_worker --socket PATH
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "Farm.hpp"
+
+int main(int argc, char** argv) {
+    std::string path;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--socket") == 0) path = argv[i + 1];
+    }
+    if (path.empty()) {
+        fprintf(stderr, "usage: %s --socket PATH\n", argv[0]);
+        return 2;
+    }
+    return runFarmWorker(path);
+}
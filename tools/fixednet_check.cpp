@@ -0,0 +1,97 @@
+// FixedNet equivalence check: a compile-time-topology network must give the
+// same forward outputs and the same mutations as the dynamic Net it came from,
+// bit for bit.
+//
+// usage: fixednet_check [--nets N] [--inputs N] [--generations G] [--seed S]
+//
+// For N random nets of the agent topology (and of a second, odd-sized one that
+// exercises the alignment padding Net has and FixedNet drops): Net -> FixedNet
+// -> Net must round-trip every parameter, forward() must return identical
+// floats on random inputs, and G rounds of mutate() with the same keys must
+// leave identical weights and outputs in both.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "Sim.hpp"
+
+using namespace std;
+
+struct Mismatches {
+    long long roundTrip = 0; // parameters changed by Net -> FixedNet -> Net
+    long long forward = 0; // outputs that differ
+    long long mutated = 0; // parameters that differ after the same mutations
+    long long compared = 0; // outputs compared
+};
+
+// Every real parameter of a and b (padding excluded) equal, counted per mismatch
+static long long differingParams(const Net& a, const Net& b) {
+    long long n = 0;
+    for (size_t l = 0; l < a.layers.size(); ++l) {
+        const float* pa = a.params.data() + a.layers[l].offset;
+        const float* pb = b.params.data() + b.layers[l].offset;
+        for (size_t k = 0; k < a.layers[l].blockSize(); ++k) n += memcmp(&pa[k], &pb[k], sizeof(float)) != 0;
+    }
+    return n;
+}
+
+template <int... Sizes>
+static Mismatches check(int nets, int inputs, int generations, std::mt19937& rng) {
+    using Fixed = FixedNet<Sizes...>;
+    Mismatches m;
+    std::uniform_real_distribution<float> u(-1.5f, 1.5f);
+    vector<float> x(Fixed::INPUTS);
+    auto compareOutputs = [&](const Net& net, const Fixed& fixed) {
+        vector<float> scratch(net.scratchSize());
+        for (int k = 0; k < inputs; ++k) {
+            for (float& v : x) v = u(rng);
+            const float a = net.forward(x.data(), scratch.data()), b = fixed.forward(x.data());
+            m.forward += memcmp(&a, &b, sizeof(float)) != 0;
+            ++m.compared;
+        }
+    };
+    for (int n = 0; n < nets; ++n) {
+        Net net(vector<int>{Sizes...}, (unsigned)rng());
+        Fixed fixed;
+        if (!fixed.fromNet(net)) { fprintf(stderr, "fromNet refused a net of its own topology\n"); exit(1); }
+        m.roundTrip += differingParams(net, fixed.toNet());
+        compareOutputs(net, fixed);
+        for (int g = 0; g < generations; ++g) {
+            const uint64_t key = mutationKey((uint32_t)rng(), (uint32_t)g, (uint32_t)n);
+            net.mutate(key, MUT_SIGMA, MUT_PROB);
+            fixed.mutate(key, MUT_SIGMA, MUT_PROB);
+        }
+        m.mutated += differingParams(net, fixed.toNet());
+        compareOutputs(net, fixed);
+    }
+    return m;
+}
+
+static bool report(const char* name, const Mismatches& m) {
+    const bool ok = m.roundTrip == 0 && m.forward == 0 && m.mutated == 0;
+    printf("%-14s round trip %lld params differ, forward %lld / %lld outputs differ, after mutate %lld params differ%s\n",
+           name, m.roundTrip, m.forward, m.compared, m.mutated, ok ? "" : "  FAIL");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    int nets = 200, inputs = 1000, generations = 20;
+    unsigned seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--nets") == 0) nets = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--inputs") == 0) inputs = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--generations") == 0) generations = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--seed") == 0) seed = (unsigned)strtoul(argv[i + 1], nullptr, 10);
+    }
+    if (nets <= 0 || inputs <= 0 || generations < 0) {
+        fprintf(stderr, "usage: %s [--nets N] [--inputs N] [--generations G] [--seed S]\n", argv[0]);
+        return 2;
+    }
+    std::mt19937 rng(seed);
+    bool ok = report("9-16-8-1", check<9, 16, 8, 1>(nets, inputs, generations, rng));
+    ok = report("5-7-3-2", check<5, 7, 3, 2>(nets, inputs, generations, rng)) && ok;
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,148 @@
+// Inference precision check: how much the fast-tanh and int8 modes change
+// agent decisions and fitness compared to exact fp32 inference.
+//
+// usage: inference_check [--population N] [--generations G] [--seed S] [--max-steps N]
+//
+// Every generation runs the exact simulation and, on the exact inputs of every
+// step, evaluates the same genomes in the other modes (decision = sign of the
+// output, as in Net::upDecision). Each mode then also plays the whole
+// generation on its own on the same cave, and its fitness is compared agent by
+// agent. The population evolves on exact fitness so all modes see the same
+// genomes.
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "Sim.hpp"
+
+using namespace std;
+
+struct ModeStats {
+    InferenceMode mode;
+    long long decisions = 0, flips = 0; // decisions compared, sign disagreements
+    double sumOutErr = 0.0, maxOutErr = 0.0; // |output - exact output|
+    double sumFitErr = 0.0, maxFitErr = 0.0; // |fitness - exact fitness| / exact fitness
+    long long agents = 0; // fitness comparisons
+    double bestExact = 0.0, bestMode = 0.0; // summed best fitness per generation
+    double forwardNs = 0.0; // ns per agent per step
+};
+
+static double forwardTime(PopulationNet& net, int reps) {
+    vector<uint8_t> alive(net.numAgents, 1);
+    auto t0 = chrono::steady_clock::now();
+    for (int r = 0; r < reps; ++r) net.forward(alive.data());
+    double s = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    return s * 1e9 / ((double)reps * net.numAgents);
+}
+
+int main(int argc, char** argv) {
+    int population = 500, generations = 10, maxSteps = 3600;
+    unsigned seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--population") == 0) population = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--generations") == 0) generations = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--seed") == 0) seed = (unsigned)strtoul(argv[i + 1], nullptr, 10);
+        else if (strcmp(argv[i], "--max-steps") == 0) maxSteps = atoi(argv[i + 1]);
+    }
+    if (population < 2 * ELITE_COUNT || generations <= 0 || maxSteps <= 0) {
+        fprintf(stderr, "usage: %s [--population N] [--generations G] [--seed S] [--max-steps N]\n", argv[0]);
+        return 2;
+    }
+
+    std::mt19937 rng(seed);
+    vector<Agent> agents; agents.reserve(population);
+    for (int i = 0; i < population; ++i) agents.emplace_back(NUM_INPUTS, (unsigned)rng());
+    EvolveBuffers buf;
+    ThreadPool pool;
+    int generation = 1;
+    float bestEver = 0.f;
+
+    ModeStats modes[2] = {{InferenceMode::FastTanh}, {InferenceMode::Int8}};
+    vector<float> exactFitness(population);
+    vector<uint8_t> aliveBefore;
+
+    for (int g = 0; g < generations; ++g) {
+        const Cave cave((unsigned)rng()); // shared by every mode this generation
+        vector<const Net*> nets;
+        for (const Agent& a : agents) nets.push_back(&a.brain);
+
+        // -- Exact run, with every step's inputs replayed through the other modes --
+        PopulationNet other[2];
+        for (int m = 0; m < 2; ++m) { other[m].setMode(modes[m].mode); other[m].load(nets); }
+        Simulation sim;
+        sim.pool = &pool;
+        sim.compactBatch = false; // keep batch rows == agents so the replays line up
+        sim.resetGeneration(agents, cave);
+        for (;;) {
+            aliveBefore = sim.rowAlive;
+            bool anyAlive = sim.step(agents, 1.f / 60.f);
+            for (int m = 0; m < 2; ++m) {
+                PopulationNet& net = other[m];
+                net.inputs = sim.batch.inputs; // same layout and topology
+                net.forward(aliveBefore.data());
+                for (int a = 0; a < population; ++a) {
+                    if (!aliveBefore[a]) continue;
+                    float ref = sim.batch.outputs[a], got = net.outputs[a];
+                    double err = fabs((double)got - ref);
+                    modes[m].decisions++;
+                    modes[m].flips += (ref > 0.f) != (got > 0.f);
+                    modes[m].sumOutErr += err;
+                    modes[m].maxOutErr = max(modes[m].maxOutErr, err);
+                }
+            }
+            if (!anyAlive) break;
+            if (sim.steps >= maxSteps) { sim.killAll(agents); break; }
+        }
+        float bestExact = 0.f;
+        for (int a = 0; a < population; ++a) { exactFitness[a] = agents[a].fitness; bestExact = max(bestExact, agents[a].fitness); }
+
+        // -- Each mode plays the generation on its own --
+        for (int m = 0; m < 2; ++m) {
+            vector<Agent> copy = agents;
+            Simulation own;
+            own.pool = &pool;
+            own.batch.setMode(modes[m].mode);
+            own.resetGeneration(copy, cave);
+            while (own.step(copy, 1.f / 60.f)) {
+                if (own.steps >= maxSteps) { own.killAll(copy); break; }
+            }
+            float best = 0.f;
+            for (int a = 0; a < population; ++a) {
+                double rel = fabs((double)copy[a].fitness - exactFitness[a]) / max(1.0, (double)exactFitness[a]);
+                modes[m].sumFitErr += rel;
+                modes[m].maxFitErr = max(modes[m].maxFitErr, rel);
+                best = max(best, copy[a].fitness);
+            }
+            modes[m].agents += population;
+            modes[m].bestExact += bestExact;
+            modes[m].bestMode += best;
+        }
+
+        if (g + 1 == generations) { // throughput on the final genomes
+            PopulationNet exact; exact.load(nets);
+            double exactNs = forwardTime(exact, 200);
+            printf("forward: exact %.1f ns/agent", exactNs);
+            for (int m = 0; m < 2; ++m) {
+                modes[m].forwardNs = forwardTime(other[m], 200);
+                printf(", %s %.1f ns/agent (%.2fx)", inferenceModeName(modes[m].mode), modes[m].forwardNs, exactNs / modes[m].forwardNs);
+            }
+            printf("\n");
+        }
+        evolve(agents, buf, rng, seed, ELITE_COUNT, MUT_SIGMA, MUT_PROB, generation, bestEver, &pool);
+    }
+
+    printf("%d agents, %d generations, seed %u\n", population, generations, seed);
+    printf("%-6s %12s %10s %12s %12s %14s %14s %12s\n",
+           "mode", "decisions", "flips %", "mean |dout|", "max |dout|", "mean |dfit|%", "max |dfit|%", "best ratio");
+    for (const ModeStats& s : modes) {
+        printf("%-6s %12lld %10.4f %12.2e %12.2e %14.3f %14.3f %12.4f\n",
+               inferenceModeName(s.mode), s.decisions, 100.0 * s.flips / max(1LL, s.decisions),
+               s.sumOutErr / max(1LL, s.decisions), s.maxOutErr,
+               100.0 * s.sumFitErr / max(1LL, s.agents), 100.0 * s.maxFitErr, s.bestMode / max(1e-9, s.bestExact));
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+// Telemetry to CSV: prints one table of a --telemetry file (see src/Telemetry.hpp)
+// as CSV, or a summary of the tables with --list.
+//
+// usage: telemetry_csv FILE [--table generations|agents] [--out CSV] [--list]
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "Telemetry.hpp"
+
+int main(int argc, char** argv) {
+    std::string path, tableName = "generations", outPath;
+    bool list = false, bad = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--table") == 0 && i + 1 < argc) tableName = argv[++i];
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) outPath = argv[++i];
+        else if (strcmp(argv[i], "--list") == 0) list = true;
+        else if (argv[i][0] != '-' && path.empty()) path = argv[i];
+        else bad = true;
+    }
+    if (path.empty() || bad) {
+        fprintf(stderr, "usage: %s FILE [--table generations|agents] [--out CSV] [--list]\n", argv[0]);
+        return 2;
+    }
+
+    TelemetryReader reader;
+    std::string error;
+    if (!reader.open(path, error)) { fprintf(stderr, "%s: %s\n", path.c_str(), error.c_str()); return 1; }
+    int wanted = -1;
+    for (size_t t = 0; t < reader.tables.size(); ++t) if (reader.tables[t].name == tableName) wanted = (int)t;
+    if (wanted < 0 && !list) { fprintf(stderr, "%s: no table '%s'\n", path.c_str(), tableName.c_str()); return 1; }
+
+    FILE* out = stdout;
+    if (!outPath.empty() && !list) {
+        out = fopen(outPath.c_str(), "w");
+        if (!out) { fprintf(stderr, "cannot open %s\n", outPath.c_str()); return 1; }
+    }
+    if (!list) {
+        const auto& cols = reader.tables[wanted].columns;
+        for (size_t c = 0; c < cols.size(); ++c) fprintf(out, "%s%s", c ? "," : "", cols[c].name.c_str());
+        fputc('\n', out);
+    }
+
+    std::vector<unsigned long long> rows(reader.tables.size(), 0), blocks(reader.tables.size(), 0);
+    while (reader.next(error)) {
+        rows[reader.table] += reader.rows;
+        blocks[reader.table]++;
+        if (list || reader.table != wanted) continue;
+        const auto& cols = reader.tables[wanted].columns;
+        for (size_t r = 0; r < reader.rows; ++r) {
+            for (size_t c = 0; c < cols.size(); ++c) {
+                const uint64_t v = reader.columns[c][r];
+                if (c) fputc(',', out);
+                if (cols[c].type == ColumnType::Int) {
+                    fprintf(out, "%lld", (long long)v);
+                } else {
+                    const uint32_t bits = (uint32_t)v;
+                    float f; memcpy(&f, &bits, 4);
+                    fprintf(out, "%.9g", f);
+                }
+            }
+            fputc('\n', out);
+        }
+    }
+    if (out != stdout) fclose(out);
+    if (!error.empty()) { fprintf(stderr, "%s: %s\n", path.c_str(), error.c_str()); return 1; }
+    if (list) {
+        for (size_t t = 0; t < reader.tables.size(); ++t) {
+            printf("%s: %llu rows in %llu blocks, %zu columns\n", reader.tables[t].name.c_str(), rows[t], blocks[t],
+                   reader.tables[t].columns.size());
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+// VecEnv check: the built-in networks driven through VecEnv must fly the same
+// episodes as the Simulation, and a cheap policy shows the raw stepping rate.
+//
+// usage: vecenv_check [--population N] [--seed S] [--envs N] [--steps N] [--threads N]
+//
+// Part 1 flies a seeded population once in the Simulation (exact rays, no
+// memo) and once as N environments on the same cave, each agent's Net
+// choosing its environment's actions. Death steps must match exactly and
+// every episode's summed rewards must match the agent's fitness.
+// Part 2 steps --envs environments for --steps steps with a proportional
+// controller on the corridor offset and reports environment steps per second.
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "VecEnv.hpp"
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    int population = 200, envs = 4096, steps = 2000, threads = 0;
+    unsigned seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--population") == 0) population = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--seed") == 0) seed = (unsigned)strtoul(argv[i + 1], nullptr, 10);
+        else if (strcmp(argv[i], "--envs") == 0) envs = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--steps") == 0) steps = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--threads") == 0) threads = atoi(argv[i + 1]);
+    }
+    if (population <= 0 || envs <= 0 || steps <= 0) {
+        fprintf(stderr, "usage: %s [--population N] [--seed S] [--envs N] [--steps N] [--threads N]\n", argv[0]);
+        return 2;
+    }
+    ThreadPool pool(threads);
+    const int maxSteps = 36000;
+    const unsigned cave = caveSeed(seed, 1);
+
+    // -- Part 1: same episodes as the Simulation --
+    std::mt19937 rng(seed);
+    vector<Agent> agents;
+    for (int i = 0; i < population; ++i) agents.emplace_back(NUM_INPUTS, (unsigned)rng());
+    Simulation sim;
+    sim.pool = &pool;
+    sim.useField = false; // VecEnv marches every ray
+    sim.resetGeneration(agents, Cave(cave));
+    while (sim.step(agents, 1.f / 60.f)) {
+        if (sim.steps >= maxSteps) { sim.killAll(agents); break; }
+    }
+
+    VecEnv env(population, &pool);
+    env.maxSteps = maxSteps;
+    vector<uint32_t> seeds(population, cave);
+    vector<float> obs((size_t)population * VecEnv::OBS_SIZE), actions(population), rewards(population);
+    vector<uint8_t> dones(population);
+    vector<double> returns(population, 0.0);
+    vector<int> deathStep(population, -1);
+    vector<float> firstReturn(population, 0.f); // episodeReturn when the first episode ended
+    env.reset(seeds.data(), obs.data());
+    int finished = 0;
+    for (int t = 1; finished < population; ++t) {
+        pool.parallelFor(population, 64, [&](int b, int e, int) {
+            thread_local vector<float> scratch;
+            for (int i = b; i < e; ++i) {
+                const Net& net = agents[i].brain;
+                if (scratch.size() < net.scratchSize()) scratch.resize(net.scratchSize());
+                actions[i] = net.forward(obs.data() + (size_t)i * VecEnv::OBS_SIZE, scratch.data());
+            }
+        });
+        env.step(actions.data(), obs.data(), rewards.data(), dones.data());
+        for (int i = 0; i < population; ++i) {
+            if (deathStep[i] >= 0) continue;
+            returns[i] += rewards[i];
+            if (dones[i]) { deathStep[i] = t; firstReturn[i] = env.episodeReturn[i]; ++finished; }
+        }
+    }
+    int stepMismatches = 0;
+    double maxRelErr = 0.0;
+    for (int i = 0; i < population; ++i) {
+        if (deathStep[i] != sim.runners.deathStep[i]) ++stepMismatches;
+        const double f = agents[i].fitness;
+        maxRelErr = std::max(maxRelErr, fabs(returns[i] - f) / std::max(1.0, fabs(f)));
+        if (fabs(firstReturn[i] - f) > 1e-3 * std::max(1.0, fabs(f))) ++stepMismatches;
+    }
+    printf("episodes: %d agents, %d death step / return mismatches, max |sum(rewards) - fitness| / fitness %.2e\n",
+           population, stepMismatches, maxRelErr);
+
+    // -- Part 2: throughput with a proportional controller --
+    VecEnv many(envs, &pool);
+    vector<uint32_t> manySeeds(envs);
+    for (int i = 0; i < envs; ++i) manySeeds[i] = caveSeed(seed, (uint64_t)i);
+    obs.assign((size_t)envs * VecEnv::OBS_SIZE, 0.f);
+    actions.assign(envs, 0.f); rewards.assign(envs, 0.f); dones.assign(envs, 0);
+    many.reset(manySeeds.data(), obs.data());
+    long long episodes = 0;
+    auto t0 = chrono::steady_clock::now();
+    for (int t = 0; t < steps; ++t) {
+        for (int i = 0; i < envs; ++i) actions[i] = std::max(-1.f, std::min(1.f, 2.f * obs[(size_t)i * VecEnv::OBS_SIZE + NUM_RAYS]));
+        many.step(actions.data(), obs.data(), rewards.data(), dones.data());
+        for (int i = 0; i < envs; ++i) episodes += dones[i] != 0;
+    }
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    printf("throughput: %d envs x %d steps in %.2fs on %d threads = %.0f env steps/s (%.0f per thread), %lld episodes ended\n",
+           envs, steps, secs, pool.size(), (double)envs * steps / secs, (double)envs * steps / secs / pool.size(), episodes);
+    return stepMismatches ? 1 : 0;
+}